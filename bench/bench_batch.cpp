@@ -0,0 +1,71 @@
+// Scaling of the batch operations over a few million synthetic log lines,
+// from one thread up to every hardware thread. Speedup is relative to the
+// single-thread run of the same operation.
+//
+//   g++ -std=c++17 -O2 -pthread -I.. bench_batch.cpp -o bench_batch
+//   ./bench_batch [million lines]    (default 4)
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "mystring.hpp"
+#include "mystring_batch.hpp"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t count = ((argc > 1) ? strtoul(argv[1], nullptr, 10) : 4) * 1000000;
+    const char* levels[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+
+    std::string text;
+    std::vector<size_t> offsets;
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        offsets.push_back(text.size());
+        text += levels[(seed >> 16) % 4];
+        text += " node=";
+        text += std::to_string((seed >> 8) % 977);
+        text += " msg=request served in ";
+        text += std::to_string(seed % 10000);
+        text += "us";
+    }
+    offsets.push_back(text.size());
+    std::vector<string_view> lines(count);
+    for (size_t i = 0; i < count; ++i) {
+        lines[i] = string_view(text.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = 1;
+    printf("%zu lines, %.0f MB, up to %u threads\n", count, text.size() / 1e6, max_threads);
+    printf("%8s %12s %8s %12s %8s %12s %8s\n", "threads", "count ms", "x", "filter ms", "x", "sort ms", "x");
+
+    double base_count = 0, base_filter = 0, base_sort = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        BatchPool pool(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t errors = batchCount(pool, lines.data(), count, TextContains("ERROR node=97"));
+        double t_count = seconds_since(start);
+
+        BatchBitmap hits;
+        start = std::chrono::steady_clock::now();
+        batchFilter(pool, lines.data(), count, TextContains("in 99"), hits);
+        double t_filter = seconds_since(start);
+
+        std::vector<string_view> sorted(lines);
+        start = std::chrono::steady_clock::now();
+        batchSort(pool, sorted.data(), count);
+        double t_sort = seconds_since(start);
+
+        if (threads == 1) { base_count = t_count; base_filter = t_filter; base_sort = t_sort; }
+        printf("%8u %12.1f %8.2f %12.1f %8.2f %12.1f %8.2f   (%zu errors, %zu hits)\n", threads,
+               t_count * 1e3, base_count / t_count, t_filter * 1e3, base_filter / t_filter,
+               t_sort * 1e3, base_sort / t_sort, errors, hits.count());
+        if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Throughput of the mystring_checksum.hpp engines against the plain
+// bit-at-a-time loop, over a 64 KB buffer.
+//
+//   g++ -std=c++17 -O2 -I.. bench_checksum.cpp -o bench_checksum
+//   ./bench_checksum
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "mystring.hpp"
+#include "mystring_checksum.hpp"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint32_t crc32_bitwise(const string_view& data) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < data.size(); ++i) {
+        crc ^= static_cast<uint8_t>(data[i]);
+        for (int k = 0; k < 8; ++k) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+template <typename F>
+static void report(const char* name, const string_view& data, int rounds, F fn) {
+    unsigned long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) sink += fn(data);
+    double t = seconds_since(start);
+    printf("%-14s %8.3f ns/byte  %7.0f MB/s  (%lx)\n", name, t * 1e9 / (double(data.size()) * rounds),
+           double(data.size()) * rounds / t / 1e6, sink & 0xF);
+}
+
+int main() {
+    std::vector<char> buf(64 * 1024);
+    for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<char>(i * 2654435761u >> 13);
+    string_view data(buf.data(), buf.size());
+
+    report("crc32 bitwise", data, 20, crc32_bitwise);
+    report("xor8", data, 2000, [](const string_view& d) { Xor8 e; e.update(d); return (unsigned long)e.value(); });
+    report("crc16 modbus", data, 200, [](const string_view& d) { Crc16Modbus e; e.update(d); return (unsigned long)e.value(); });
+    report("crc32 slice-8", data, 500, [](const string_view& d) { Crc32 e; e.update(d); return (unsigned long)e.value(); });
+    report("crc32c table", data, 500, [](const string_view& d) { Crc32c e; e.updateSoftware(d); return (unsigned long)e.value(); });
+    report("crc32c", data, 2000, [](const string_view& d) { Crc32c e; e.update(d); return (unsigned long)e.value(); });
+    printf("crc32c hardware: %s\n", Crc32c::hardware() ? "yes" : "no");
+    return 0;
+}
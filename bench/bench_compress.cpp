@@ -0,0 +1,83 @@
+// Compression ratio and speed of mystring_compress.hpp on short UI and log
+// strings, using the built-in codebook. Pass a file with one string per line
+// to measure your own string table instead of the built-in sample.
+//
+//   g++ -std=c++17 -O2 -I.. bench_compress.cpp -o bench_compress
+//   ./bench_compress [strings.txt]
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mystring.hpp"
+#include "mystring_compress.hpp"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char* const SAMPLE[] = {
+    "Battery low, please connect charger",
+    "ERROR: sensor timeout after %d ms",
+    "WARN: temperature above threshold",
+    "WiFi connected to network %s",
+    "WiFi disconnected, retrying in %d s",
+    "Press the button to start calibration",
+    "INFO: configuration saved",
+    "Invalid value for setting %s",
+    "Update available, please restart the device",
+    "Status: ready",
+    "DEBUG: reading sensor %d returned %d",
+    "Failed to write file %s",
+    "Menu > Network > Status",
+    "Connection timeout, check the power supply",
+    "Temperature: %d C  Humidity: %d %%",
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::string> texts;
+    if (argc > 1) {
+        std::ifstream in(argv[1]);
+        for (std::string line; std::getline(in, line);) texts.push_back(line);
+    } else {
+        for (const char* s : SAMPLE) texts.push_back(s);
+    }
+
+    size_t raw = 0, packed_total = 0;
+    std::vector<DynamicString> packed;
+    for (const std::string& t : texts) {
+        packed.emplace_back(t.size() + 8);
+        smallCompress(defaultCodebook(), string_view(t.data(), t.size()), packed.back());
+        raw += t.size();
+        packed_total += packed.back().size();
+    }
+
+    const int rounds = 20000;
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const std::string& t : texts) {
+            FixedString<512> out;
+            smallCompress(defaultCodebook(), string_view(t.data(), t.size()), out);
+            sink += out.size();
+        }
+    }
+    double t_compress = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const DynamicString& p : packed) {
+            FixedString<512> out;
+            smallDecompress(defaultCodebook(), p, out);
+            sink += out.size();
+        }
+    }
+    double t_decompress = seconds_since(start);
+
+    double bytes = double(raw) * rounds;
+    printf("%zu strings, %zu bytes -> %zu bytes (ratio %.2f, %.1f%% saved)\n", texts.size(), raw,
+           packed_total, double(packed_total) / raw, 100.0 * (raw - packed_total) / raw);
+    printf("compress   %6.2f ns/byte\n", t_compress * 1e9 / bytes);
+    printf("decompress %6.2f ns/byte\n", t_decompress * 1e9 / bytes);
+    return sink == 0;
+}
@@ -0,0 +1,77 @@
+// Line iteration throughput: MappedFile + lines() against the copying
+// approach of reading every line into a string buffer. (Accumulating the
+// whole file in a DynamicString with concat is left out: its +16 growth
+// step makes that quadratic and it does not finish at these sizes.)
+//
+//   g++ -std=c++17 -O2 -I.. bench_lines.cpp -o bench_lines
+//   ./bench_lines [megabytes]        (default 512)
+#include <chrono>
+#include <cstdlib>
+
+#include "mystring.hpp"
+#include "mystring_file.hpp"
+#include "mystring_sink.hpp"
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 512;
+    char path[] = "/tmp/bench_lines_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 1;
+
+    // log-like lines of varying length
+    {
+        FdSink<1 << 16> out(fd);
+        FixedString<128> line;
+        size_t written = 0;
+        for (unsigned i = 0; written < megabytes * 1024 * 1024; ++i) {
+            line = "2026-10-18T12:00:00Z INFO sensor=";
+            line.concat(static_cast<int>(i % 977));
+            line.concat(" value=");
+            line.concat(static_cast<int>(i * 2654435761u % 100000));
+            for (unsigned pad = i % 40; pad > 0; --pad) line.concat('.');
+            line.concat('\n');
+            out.write(line);
+            written += line.size();
+        }
+    }
+
+    MappedFile file(path);
+    if (!file.isOpen()) return 1;
+    double gb = file.size() / 1e9;
+
+    // first pass only faults the pages in
+    size_t lines = 0, bytes = 0;
+    for (const string_view& l : file.lines()) bytes += l.size();
+
+    auto start = std::chrono::steady_clock::now();
+    lines = 0;
+    bytes = 0;
+    for (const string_view& l : file.lines()) {
+        ++lines;
+        bytes += l.size();
+    }
+    double t_mmap = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    FixedString<256> copy;
+    size_t copied_lines = 0;
+    FILE* f = fopen(path, "rb");
+    char buf[256];
+    while (f && fgets(buf, sizeof(buf), f)) {
+        copy = buf;
+        ++copied_lines;
+    }
+    if (f) fclose(f);
+    double t_copy = seconds_since(start);
+
+    printf("%.2f GB, %zu lines (%zu payload bytes)\n", gb, lines, bytes);
+    printf("MappedFile lines():        %6.2f GB/s\n", gb / t_mmap);
+    printf("fgets + FixedString copy:  %6.2f GB/s\n", gb / t_copy);
+
+    unlink(path);
+    return copied_lines == lines ? 0 : 1;
+}
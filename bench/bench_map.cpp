@@ -0,0 +1,99 @@
+// FlatStringMap vs std::map<std::string, int>: lookup time and memory.
+//
+//   g++ -std=c++17 -O2 -I.. bench_map.cpp -o bench_map && ./bench_map
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mystring.hpp"
+#include "mystring_map.hpp"
+
+static size_t g_heap_bytes = 0;
+
+void* operator new(size_t n) {
+    g_heap_bytes += n;
+    void* p = malloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static const size_t KEYS = 20000;
+static const size_t LOOKUPS = 2000000;
+
+typedef FlatStringMap<int, KEYS, 512 * 1024, 1> PlainMap;
+typedef FlatStringMap<int, KEYS, 512 * 1024, 16> FrontCodedMap;
+
+template <typename F>
+static double ns_per_lookup(F lookup, const std::vector<std::string>& queries) {
+    volatile long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < LOOKUPS; ++i) sink += lookup(queries[i % queries.size()]);
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / LOOKUPS;
+}
+
+int main() {
+    std::vector<std::string> keys;
+    keys.reserve(KEYS);
+    srand(42);
+    const char* groups[] = { "wifi", "mqtt", "sensor", "display", "power", "log" };
+    for (size_t i = 0; i < KEYS; ++i) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s.channel%04u.%s", groups[rand() % 6],
+                 (unsigned)(rand() % 5000), (rand() & 1) ? "threshold" : "enabled");
+        keys.push_back(buf);
+    }
+
+    std::vector<string_view> views(keys.begin(), keys.end());
+    std::vector<int> values(KEYS);
+    for (size_t i = 0; i < KEYS; ++i) values[i] = static_cast<int>(i);
+
+    size_t before = g_heap_bytes;
+    std::map<std::string, int> stdmap;
+    for (size_t i = 0; i < KEYS; ++i) stdmap[keys[i]] = values[i];
+    size_t stdmap_bytes = g_heap_bytes - before;
+
+    static PlainMap plain;
+    static FrontCodedMap coded;
+    auto t0 = std::chrono::steady_clock::now();
+    plain.build(views.data(), values.data(), KEYS);
+    auto t1 = std::chrono::steady_clock::now();
+    coded.build(views.data(), values.data(), KEYS);
+
+    std::vector<std::string> queries(keys);
+    for (size_t i = 0; i < queries.size(); i += 4) queries[i] += "x";  // 25% misses
+    std::shuffle(queries.begin(), queries.end(), std::mt19937(7));
+
+    double t_std = ns_per_lookup([&](const std::string& q) {
+        auto it = stdmap.find(q);
+        return it == stdmap.end() ? 0 : it->second;
+    }, queries);
+    double t_plain = ns_per_lookup([&](const std::string& q) {
+        const int* v = plain.get(string_view(q.data(), q.size()));
+        return v ? *v : 0;
+    }, queries);
+    double t_coded = ns_per_lookup([&](const std::string& q) {
+        const int* v = coded.get(string_view(q.data(), q.size()));
+        return v ? *v : 0;
+    }, queries);
+
+    size_t plain_bytes = plain.arenaUsed() + (plain.size() + 1) * sizeof(uint32_t) + plain.size() * sizeof(int);
+    size_t coded_bytes = coded.arenaUsed() + (coded.size() + 1) * sizeof(uint32_t) + coded.size() * sizeof(int);
+
+    printf("%zu unique keys, %zu lookups (25%% misses)\n", plain.size(), LOOKUPS);
+    printf("build (multikey quicksort + pack): %.2f ms\n",
+           std::chrono::duration<double, std::milli>(t1 - t0).count());
+    printf("%-26s %10s %12s\n", "", "ns/lookup", "bytes used");
+    printf("%-26s %10.1f %12zu\n", "std::map<std::string,int>", t_std, stdmap_bytes);
+    printf("%-26s %10.1f %12zu\n", "FlatStringMap", t_plain, plain_bytes);
+    printf("%-26s %10.1f %12zu\n", "FlatStringMap, front coded", t_coded, coded_bytes);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Thousands of simulated connections on one thread, each fed the same line
+// protocol in random-sized chunks (as TCP segments arrive), interleaved
+// round-robin. Compares the coroutine framer of mystring_pipeline.hpp with
+// per-connection DynamicString accumulation and find("\r\n") rescans, and
+// reports the heap each connection holds.
+//
+//   g++ -std=c++20 -O2 -I.. bench_pipeline.cpp -o bench_pipeline
+//   ./bench_pipeline [connections]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "mystring.hpp"
+#include "mystring_pipeline.hpp"
+#include "mystring_scan.hpp"
+
+static size_t g_heap_bytes = 0;
+
+void* operator new(size_t n) {
+    g_heap_bytes += n;
+    if (void* p = malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Totals {
+    size_t messages = 0;
+    unsigned long id_sum = 0;
+
+    void add(const string_view& line) {
+        float t;
+        int h;
+        unsigned id;
+        if (scan<"T=%f,H=%d,ID=%u">(line, t, h, id).complete) {
+            ++messages;
+            id_sum += id;
+        }
+    }
+};
+
+PipeStage handler(Totals& totals) {
+    string_view line;
+    while (co_await receive(line)) totals.add(line);
+}
+
+struct Connection {
+    PipeStage sink;
+    PipeStage framer;
+};
+
+struct Baseline {
+    DynamicString acc;
+    Baseline() : acc(64) {}
+
+    void feed(const string_view& chunk, Totals& totals) {
+        acc.concat(chunk);
+        int pos;
+        while ((pos = acc.find("\r\n")) >= 0) {
+            totals.add(string_view(acc.data(), static_cast<size_t>(pos)));
+            acc.erase(0, static_cast<size_t>(pos) + 2);
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    size_t conns = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 10000;
+
+    // One 16 KB stream, replayed by every connection with its own splits.
+    std::vector<char> stream;
+    unsigned lines = 0;
+    while (stream.size() < 16 * 1024) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "T=%d.%d,H=%u,ID=%u\r\n", 15 + lines % 20, lines % 10, 30 + lines % 50,
+                         lines);
+        stream.insert(stream.end(), line, line + n);
+        ++lines;
+    }
+
+    // Chunk boundaries: 1..1460 bytes, fixed per connection and round.
+    std::vector<std::vector<uint16_t>> splits(conns);
+    srand(1);
+    size_t rounds = 0;
+    for (size_t c = 0; c < conns; ++c) {
+        for (size_t off = 0; off < stream.size();) {
+            size_t n = 1 + static_cast<size_t>(rand()) % 1460;
+            if (n > stream.size() - off) n = stream.size() - off;
+            splits[c].push_back(static_cast<uint16_t>(n));
+            off += n;
+        }
+        if (splits[c].size() > rounds) rounds = splits[c].size();
+    }
+    double total_mb = double(conns) * stream.size() / 1e6;
+
+    {
+        Totals totals;
+        FrameStats stats;
+        size_t heap_before = g_heap_bytes;
+        std::vector<Connection> pipes(conns);
+        for (size_t c = 0; c < conns; ++c) {
+            pipes[c].sink = handler(totals);
+            pipes[c].framer = lineFramer<128>(pipes[c].sink, &stats);
+        }
+        size_t heap = g_heap_bytes - heap_before;
+        std::vector<size_t> offset(conns, 0);
+        size_t heap_running = g_heap_bytes;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t c = 0; c < conns; ++c) {
+                if (r >= splits[c].size()) continue;
+                pipes[c].framer.push(string_view(stream.data() + offset[c], splits[c][r]));
+                offset[c] += splits[c][r];
+            }
+        }
+        for (size_t c = 0; c < conns; ++c) pipes[c].framer.close();
+        double t = seconds_since(start);
+        printf("coroutine framer: %zu conns, %zu msgs (%zu gathered), %.0f MB/s, %.1f ns/msg, %zu B heap/conn, "
+               "%zu B allocated/conn while running\n",
+               conns, totals.messages, stats.copied, total_mb / t, t * 1e9 / totals.messages, heap / conns,
+               (g_heap_bytes - heap_running) / conns);
+    }
+    {
+        Totals totals;
+        std::vector<Baseline> conns_state(conns);
+        std::vector<size_t> offset(conns, 0);
+        size_t heap_before = g_heap_bytes;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t c = 0; c < conns; ++c) {
+                if (r >= splits[c].size()) continue;
+                conns_state[c].feed(string_view(stream.data() + offset[c], splits[c][r]), totals);
+                offset[c] += splits[c][r];
+            }
+        }
+        double t = seconds_since(start);
+        printf("DynamicString + find: %zu msgs, %.0f MB/s, %.1f ns/msg, %zu B allocated/conn while running\n",
+               totals.messages, total_mb / t, t * 1e9 / totals.messages, (g_heap_bytes - heap_before) / conns);
+    }
+    return 0;
+}
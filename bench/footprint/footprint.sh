@@ -0,0 +1,49 @@
+#!/bin/sh
+# Flash/RAM cost of each library feature. Every fp_*.cpp is a minimal
+# program using one feature; the report lists text/data/bss per program and
+# the text delta over fp_baseline. Run it for every release and compare.
+#
+#   ./footprint.sh                 host build with $CXX (default g++)
+#   CROSS=arm-none-eabi- ./footprint.sh
+#
+# Host programs are linked statically, so whatever a feature pulls out of
+# libc and libstdc++ (snprintf, iostream) counts against it as it would
+# on a microcontroller. Set HOST_LINK= to measure a dynamic build instead.
+# Programs that do not print define MYSTRING_NO_IOSTREAM.
+#
+# A cross build is added automatically when arm-none-eabi-g++ is on PATH.
+# Cross programs are linked with newlib-nano and nosys stubs, and print()
+# goes through stdio there (-DMYSTRING_NO_IOSTREAM).
+set -e
+cd "$(dirname "$0")"
+OUT=${OUT:-/tmp/mystring_footprint}
+FLAGS="-std=c++11 -Os -I../.. -ffunction-sections -fdata-sections -fno-exceptions -fno-rtti -Wl,--gc-sections"
+mkdir -p "$OUT"
+
+report() {  # report <label> <c++ compiler> <size tool> <extra flags> <skip>
+    label=$1; cxx=$2; size=$3; extra=$4; skip=$5
+    echo "== $label ($cxx)"
+    printf '%-12s %8s %8s %8s %10s\n' feature text data bss text+/-
+    base=
+    for src in fp_baseline.cpp fp_*.cpp; do
+        name=${src%.cpp}; name=${name#fp_}
+        case " $skip " in *" $name "*) continue ;; esac
+        [ "$name" = baseline ] && [ -n "$base" ] && continue
+        bin="$OUT/$label-$name"
+        $cxx $FLAGS $extra "$src" -o "$bin"
+        set -- $($size "$bin" | tail -n 1)
+        [ -z "$base" ] && base=$1
+        printf '%-12s %8s %8s %8s %10s\n' "$name" "$1" "$2" "$3" "$(( $1 - base ))"
+    done
+}
+
+report host "${CXX:-g++}" size "${HOST_LINK--static}" ""
+
+CROSS=${CROSS:-}
+if [ -z "$CROSS" ] && command -v arm-none-eabi-g++ >/dev/null 2>&1; then
+    CROSS=arm-none-eabi-
+fi
+if [ -n "$CROSS" ]; then
+    report cross "${CROSS}g++" "${CROSS}size" \
+        "-mcpu=cortex-m0plus -mthumb --specs=nano.specs --specs=nosys.specs -DMYSTRING_NO_IOSTREAM" ""
+fi
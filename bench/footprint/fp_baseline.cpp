@@ -0,0 +1,8 @@
+// Reference point: the same main() shape with no library code, so the
+// report can subtract startup code and libc.
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    (void)argv;
+    return argc > 1 ? 1 : 0;
+}
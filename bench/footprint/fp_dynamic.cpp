@@ -0,0 +1,9 @@
+// DynamicString: the string vtable plus operator new/delete.
+#define MYSTRING_NO_IOSTREAM  // nothing here prints
+#include "mystring.hpp"
+
+int main(int argc, char** argv) {
+    DynamicString msg("arg:");
+    for (int i = 1; i < argc; ++i) msg.concat(string_view(argv[i]));
+    return static_cast<int>(msg.size());
+}
@@ -0,0 +1,10 @@
+// FixedString: pulls in the string vtable but no heap.
+#define MYSTRING_NO_IOSTREAM  // nothing here prints
+#include "mystring.hpp"
+
+int main(int argc, char** argv) {
+    FixedString<32> msg("arg:");
+    msg.concat(string_view(argc > 1 ? argv[1] : ""));
+    msg.replace("arg", "ARG");
+    return static_cast<int>(msg.size());
+}
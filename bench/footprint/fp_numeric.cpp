@@ -0,0 +1,12 @@
+// Number formatting into a FixedString (to_chars: integers and floats by
+// hand, so no printf family).
+#define MYSTRING_NO_IOSTREAM  // nothing here prints
+#include "mystring.hpp"
+
+int main(int argc, char** argv) {
+    (void)argv;
+    FixedString<32> msg("n=");
+    msg.concat(argc * 1000 + 7);
+    msg.concat(static_cast<float>(argc) / 3.0f);
+    return static_cast<int>(msg.size());
+}
@@ -0,0 +1,8 @@
+// string_view::print(): std::cout on hosts (stdio with
+// MYSTRING_NO_IOSTREAM, as in the cross build), Serial on Arduino.
+#include "mystring.hpp"
+
+int main(int argc, char** argv) {
+    string_view(argc > 1 ? argv[1] : "hello").print();
+    return 0;
+}
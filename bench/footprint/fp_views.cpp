@@ -0,0 +1,9 @@
+// string_view only: comparisons and searches, no string hierarchy.
+#define MYSTRING_NO_IOSTREAM  // nothing here prints
+#include "mystring.hpp"
+
+int main(int argc, char** argv) {
+    string_view arg(argc > 1 ? argv[1] : "");
+    int hit = arg.find("needle");
+    return (arg.startsWith("--") ? 2 : 0) + (hit >= 0 ? 1 : 0) + (arg == "help" ? 4 : 0);
+}
@@ -1,17 +1,37 @@
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-// 1. Conditionally include PC/C++20 headers
-#ifndef ARDUINO
+// 1. Conditionally include PC/C++20 headers. Define MYSTRING_NO_IOSTREAM
+// to keep <iostream> and its static initialiser out of a program; print()
+// and StdoutSink then write through stdio instead.
+#if !defined(ARDUINO) && !defined(MYSTRING_NO_IOSTREAM)
 #include <iostream>
+#define MYSTRING_HAS_IOSTREAM
 #endif
 
 #if __cplusplus >= 202002L
 #include <compare>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+// SSSE3 Base64 encoding is picked at run time, so the header needs no -mssse3.
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+#define MYSTRING_BASE64_SSSE3
+#endif
+
+// Tables that are built by loops can be constexpr (and land in flash) from C++14 on
+#if __cplusplus >= 201402L
+#define MYSTRING_CONSTEXPR14 constexpr
+#else
+#define MYSTRING_CONSTEXPR14
+#endif
+
 // 2. STL string checks
 #if defined(__has_include)
 #  if __has_include(<string>)
@@ -36,6 +56,696 @@
 #define PRINT_WARNING(msg) printf("%s\n", msg)
 #endif
 
+// 5. UTF-8 helpers. Words are scanned 8 bytes at a time (16 per loop) on
+// 64-bit hosts and 4 bytes at a time (8 per loop) on 32/16-bit MCUs.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t utf8_word;
+#else
+typedef uint32_t utf8_word;
+#endif
+
+static const utf8_word UTF8_HIGH_BITS = (utf8_word)~(utf8_word)0 / 0xFF * 0x80;
+
+inline utf8_word utf8_load(const char* p) {
+    utf8_word w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// Length of the longest run of ASCII bytes at the start of s.
+inline size_t utf8_ascii_prefix(const char* s, size_t len) {
+    size_t i = 0;
+    while (i + 2 * sizeof(utf8_word) <= len) {
+        if ((utf8_load(s + i) | utf8_load(s + i + sizeof(utf8_word))) & UTF8_HIGH_BITS) break;
+        i += 2 * sizeof(utf8_word);
+    }
+    while (i < len && !(s[i] & 0x80)) ++i;
+    return i;
+}
+
+// Decodes one sequence at s[0..len). Returns its byte length, or 0 if the
+// bytes are not a valid, shortest-form encoding of a scalar value.
+inline size_t utf8_decode(const char* s, size_t len, uint32_t* out) {
+    const unsigned char* p = (const unsigned char*)s;
+    unsigned char b0 = p[0];
+    size_t n;
+    uint32_t cp, min;
+
+    if (b0 < 0x80) { *out = b0; return 1; }
+    else if ((b0 & 0xE0) == 0xC0) { n = 2; cp = b0 & 0x1F; min = 0x80; }
+    else if ((b0 & 0xF0) == 0xE0) { n = 3; cp = b0 & 0x0F; min = 0x800; }
+    else if ((b0 & 0xF8) == 0xF0) { n = 4; cp = b0 & 0x07; min = 0x10000; }
+    else return 0;
+
+    if (n > len) return 0;
+    for (size_t i = 1; i < n; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    *out = cp;
+    return n;
+}
+
+// Largest cut <= max_len that does not split a multi-byte sequence of s.
+inline size_t utf8_safe_cut(const char* s, size_t len, size_t max_len) {
+    if (max_len >= len) return len;
+    size_t cut = max_len;
+    size_t limit = (cut > 3) ? cut - 3 : 0;
+    while (cut > limit && (s[cut] & 0xC0) == 0x80) --cut;
+    return cut;
+}
+
+class utf8_iterator {
+    const char* m_pos;
+    const char* m_end;
+
+public:
+    utf8_iterator(const char* pos, const char* end) : m_pos(pos), m_end(end) {}
+
+    // Invalid bytes decode as U+FFFD and are skipped one at a time.
+    uint32_t operator*() const {
+        uint32_t cp;
+        return utf8_decode(m_pos, m_end - m_pos, &cp) ? cp : 0xFFFD;
+    }
+
+    utf8_iterator& operator++() {
+        uint32_t cp;
+        size_t n = utf8_decode(m_pos, m_end - m_pos, &cp);
+        m_pos += n ? n : 1;
+        return *this;
+    }
+
+    const char* position() const { return m_pos; }
+    bool operator==(const utf8_iterator& other) const { return m_pos == other.m_pos; }
+    bool operator!=(const utf8_iterator& other) const { return m_pos != other.m_pos; }
+};
+
+struct utf8_range {
+    const char* first;
+    const char* last;
+    utf8_iterator begin() const { return utf8_iterator(first, last); }
+    utf8_iterator end() const { return utf8_iterator(last, last); }
+};
+
+// 6. Hex / Base64 kernels. Encoders write a precomputed number of bytes
+// straight into the destination; x86 hosts get 16-byte SIMD loops.
+static const char HEX_DIGITS_LOWER[] = "0123456789abcdef";
+static const char HEX_DIGITS_UPPER[] = "0123456789ABCDEF";
+static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+inline size_t hex_encoded_size(size_t n) { return n * 2; }
+inline size_t base64_encoded_size(size_t n) { return (n + 2) / 3 * 4; }
+
+// Writes exactly 2 * n bytes to out.
+inline void hex_encode(const uint8_t* in, size_t n, char* out, bool uppercase) {
+    const char* digits = uppercase ? HEX_DIGITS_UPPER : HEX_DIGITS_LOWER;
+    size_t i = 0;
+#if defined(__SSE2__)
+    // nibble + '0', plus ('a' - '0' - 10) for nibbles above 9
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        __m128i lo = _mm_and_si128(v, mask);
+        hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+        lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+        _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[2 * i] = digits[in[i] >> 4];
+        out[2 * i + 1] = digits[in[i] & 0x0F];
+    }
+}
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes n / 2 bytes; returns false on an odd length or a non-hex digit.
+inline bool hex_decode(const char* in, size_t n, uint8_t* out) {
+    if (n & 1) return false;
+    for (size_t i = 0; i < n; i += 2) {
+        int hi = hex_value(in[i]);
+        int lo = hex_value(in[i + 1]);
+        if ((hi | lo) < 0) return false;
+        out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+#if defined(MYSTRING_BASE64_SSSE3)
+// Mula/Lemire: spread 12 input bytes over 16 6-bit lanes with pshufb and
+// multiplies, then map lanes to ASCII with a 16-entry offset table. Returns
+// the number of input bytes encoded, a multiple of 3.
+__attribute__((target("ssse3"))) inline size_t base64_encode_ssse3(const uint8_t* in, size_t n, char* out) {
+    size_t i = 0;
+    const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    for (; i + 16 <= n; i += 12) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + i)), spread);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0FC0FC00)),
+                                     _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003F03F0)),
+                                     _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(t0, t1);
+        __m128i sel = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        sel = _mm_or_si128(sel, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx),
+                                              _mm_set1_epi8(13)));
+        __m128i ascii = _mm_add_epi8(_mm_shuffle_epi8(offsets, sel), idx);
+        _mm_storeu_si128((__m128i*)(out + i / 3 * 4), ascii);
+    }
+    return i;
+}
+#endif
+
+// Writes exactly base64_encoded_size(n) bytes to out, with '=' padding.
+inline void base64_encode(const uint8_t* in, size_t n, char* out) {
+    size_t i = 0;
+#if defined(MYSTRING_BASE64_SSSE3)
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    if (ssse3) i = base64_encode_ssse3(in, n, out);
+#endif
+    char* o = out + i / 3 * 4;
+    for (; i + 3 <= n; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        *o++ = BASE64_ALPHABET[v >> 18];
+        *o++ = BASE64_ALPHABET[(v >> 12) & 0x3F];
+        *o++ = BASE64_ALPHABET[(v >> 6) & 0x3F];
+        *o++ = BASE64_ALPHABET[v & 0x3F];
+    }
+    if (i < n) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < n) v |= (uint32_t)in[i + 1] << 8;
+        *o++ = BASE64_ALPHABET[v >> 18];
+        *o++ = BASE64_ALPHABET[(v >> 12) & 0x3F];
+        *o++ = (i + 1 < n) ? BASE64_ALPHABET[(v >> 6) & 0x3F] : '=';
+        *o++ = '=';
+    }
+}
+
+inline int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+// Decoded size of padded or unpadded input, or (size_t)-1 if the length
+// cannot be Base64.
+inline size_t base64_decoded_size(const char* in, size_t n) {
+    if (n > 0 && in[n - 1] == '=') --n;
+    if (n > 0 && in[n - 1] == '=') --n;
+    if (n % 4 == 1) return (size_t)-1;
+    return n / 4 * 3 + ((n % 4) ? (n % 4) - 1 : 0);
+}
+
+// Decodes into out, which must hold base64_decoded_size() bytes.
+inline bool base64_decode(const char* in, size_t n, uint8_t* out) {
+    if (n > 0 && in[n - 1] == '=') --n;
+    if (n > 0 && in[n - 1] == '=') --n;
+    if (n % 4 == 1) return false;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int a = base64_value(in[i]), b = base64_value(in[i + 1]);
+        int c = base64_value(in[i + 2]), d = base64_value(in[i + 3]);
+        if ((a | b | c | d) < 0) return false;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        *out++ = (uint8_t)(v >> 16);
+        *out++ = (uint8_t)(v >> 8);
+        *out++ = (uint8_t)v;
+    }
+    if (i < n) {
+        int a = base64_value(in[i]), b = base64_value(in[i + 1]);
+        int c = (i + 2 < n) ? base64_value(in[i + 2]) : 0;
+        if ((a | b | c) < 0) return false;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+        *out++ = (uint8_t)(v >> 16);
+        if (i + 2 < n) *out++ = (uint8_t)(v >> 8);
+    }
+    return true;
+}
+
+// Percent-encoding and C/JSON escaping. A scan for the first byte that
+// needs escaping skips clean runs 16 bytes (SSE2) or one word (SWAR) at a
+// time, so clean spans are copied with a single memcpy.
+enum EscapeMode { ESCAPE_URL, ESCAPE_JSON, ESCAPE_C };
+
+// URL: everything but RFC 3986 unreserved characters. JSON: quote,
+// backslash and control characters. C: those plus the single quote, DEL
+// and every non-ASCII byte.
+inline bool escape_needed(unsigned char c, EscapeMode mode) {
+    if (mode == ESCAPE_URL) {
+        return !((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                 c == '-' || c == '.' || c == '_' || c == '~');
+    }
+    if (c < 0x20 || c == '"' || c == '\\') return true;
+    return mode == ESCAPE_C && (c == '\'' || c >= 0x7F);
+}
+
+inline utf8_word swar_has_zero(utf8_word x) {
+    const utf8_word ones = (utf8_word)~(utf8_word)0 / 0xFF;
+    return (x - ones) & ~x & UTF8_HIGH_BITS;
+}
+
+inline utf8_word swar_has_byte(utf8_word x, unsigned char c) {
+    return swar_has_zero(x ^ ((utf8_word)~(utf8_word)0 / 0xFF * c));
+}
+
+// Length of the longest prefix of s that needs no escaping.
+inline size_t escape_clean_prefix(const char* s, size_t n, EscapeMode mode) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        int clean;
+        if (mode == ESCAPE_URL) {
+            // Bytes >= 0x80 are negative as signed and fall outside every range.
+            __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+            __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                          _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+            __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                          _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+            __m128i punct = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                                                      _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                                                      _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+            clean = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), punct));
+        } else {
+            __m128i ctrl = _mm_cmpeq_epi8(_mm_subs_epu8(v, _mm_set1_epi8(0x1F)), _mm_setzero_si128());
+            __m128i dirty = _mm_or_si128(ctrl, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                            _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+            if (mode == ESCAPE_C) {
+                __m128i high = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x7F)), v);  // v >= 0x7F
+                dirty = _mm_or_si128(dirty, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\'')), high));
+            }
+            clean = ~_mm_movemask_epi8(dirty) & 0xFFFF;
+        }
+        if (clean != 0xFFFF) return i + __builtin_ctz(~clean);
+    }
+#endif
+    if (mode != ESCAPE_URL) {
+        const utf8_word ones = (utf8_word)~(utf8_word)0 / 0xFF;
+        for (; i + sizeof(utf8_word) <= n; i += sizeof(utf8_word)) {
+            utf8_word w = utf8_load(s + i);
+            utf8_word dirty = ((w - ones * 0x20) & ~w & UTF8_HIGH_BITS) |
+                              swar_has_byte(w, '"') | swar_has_byte(w, '\\');
+            if (mode == ESCAPE_C) dirty |= (w & UTF8_HIGH_BITS) | swar_has_byte(w, '\'') | swar_has_byte(w, 0x7F);
+            if (dirty) break;
+        }
+    }
+    while (i < n && !escape_needed(static_cast<unsigned char>(s[i]), mode)) ++i;
+    return i;
+}
+
+// Bytes the escaped form of c takes (1 when c is clean).
+inline size_t escape_unit_size(unsigned char c, EscapeMode mode) {
+    if (!escape_needed(c, mode)) return 1;
+    if (mode == ESCAPE_URL) return 3;  // %XX
+    switch (c) {
+        case '"': case '\\': case '\n': case '\r': case '\t': case '\b': case '\f': return 2;
+        case '\'': return 2;  // C only
+        default: return mode == ESCAPE_JSON ? 6 : 4;  // \u00XX or \ooo
+    }
+}
+
+inline char* escape_unit_write(unsigned char c, EscapeMode mode, char* o) {
+    if (mode == ESCAPE_URL) {
+        *o++ = '%';
+        *o++ = HEX_DIGITS_UPPER[c >> 4];
+        *o++ = HEX_DIGITS_UPPER[c & 0x0F];
+        return o;
+    }
+    char named = 0;
+    switch (c) {
+        case '"': named = '"'; break;
+        case '\\': named = '\\'; break;
+        case '\'': named = '\''; break;
+        case '\n': named = 'n'; break;
+        case '\r': named = 'r'; break;
+        case '\t': named = 't'; break;
+        case '\b': named = 'b'; break;
+        case '\f': named = 'f'; break;
+    }
+    *o++ = '\\';
+    if (named) {
+        *o++ = named;
+    } else if (mode == ESCAPE_JSON) {
+        *o++ = 'u'; *o++ = '0'; *o++ = '0';
+        *o++ = HEX_DIGITS_LOWER[c >> 4];
+        *o++ = HEX_DIGITS_LOWER[c & 0x0F];
+    } else {
+        // Always three octal digits, so a following digit cannot extend it.
+        *o++ = static_cast<char>('0' + (c >> 6));
+        *o++ = static_cast<char>('0' + ((c >> 3) & 7));
+        *o++ = static_cast<char>('0' + (c & 7));
+    }
+    return o;
+}
+
+inline size_t escaped_size(const char* s, size_t n, EscapeMode mode) {
+    size_t total = 0, i = 0;
+    while (i < n) {
+        size_t clean = escape_clean_prefix(s + i, n - i, mode);
+        total += clean;
+        i += clean;
+        if (i < n) total += escape_unit_size(static_cast<unsigned char>(s[i++]), mode);
+    }
+    return total;
+}
+
+// Writes the escaped form of s into out, stopping before the first escape
+// that would not fit in room. Returns the bytes written; *consumed is how
+// much of s they cover.
+inline size_t escape_write(const char* s, size_t n, EscapeMode mode, char* out, size_t room, size_t* consumed) {
+    char* o = out;
+    size_t i = 0;
+    while (i < n) {
+        size_t clean = escape_clean_prefix(s + i, n - i, mode);
+        size_t left = room - (o - out);
+        if (clean > left) clean = left;
+        memcpy(o, s + i, clean);
+        o += clean;
+        i += clean;
+        if (i == n) break;
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (!escape_needed(c, mode) || escape_unit_size(c, mode) > room - (o - out)) break;
+        o = escape_unit_write(c, mode, o);
+        ++i;
+    }
+    *consumed = i;
+    return o - out;
+}
+
+inline size_t utf8_encode(uint32_t cp, char* out) {
+    if (cp < 0x80) { out[0] = static_cast<char>(cp); return 1; }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+inline bool hex_digits_value(const char* p, size_t count, uint32_t* value) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int d = hex_value(p[i]);
+        if (d < 0) return false;
+        v = (v << 4) | static_cast<uint32_t>(d);
+    }
+    *value = v;
+    return true;
+}
+
+// Decodes one escape starting at s[0] (the '%' or '\\'). Returns the input
+// bytes consumed, or 0 if malformed; writes at most 4 bytes to out and
+// sets *written.
+inline size_t unescape_unit(const char* s, size_t n, EscapeMode mode, char* out, size_t* written) {
+    uint32_t v;
+    *written = 1;
+    if (mode == ESCAPE_URL) {
+        if (n < 3 || !hex_digits_value(s + 1, 2, &v)) return 0;
+        out[0] = static_cast<char>(v);
+        return 3;
+    }
+    if (n < 2) return 0;
+    char c = s[1];
+    switch (c) {
+        case '"': case '\\': case '/': case '\'': case '?':
+            if ((c == '\'' || c == '?') && mode == ESCAPE_JSON) return 0;
+            if (c == '/' && mode == ESCAPE_C) return 0;
+            out[0] = c; return 2;
+        case 'n': out[0] = '\n'; return 2;
+        case 'r': out[0] = '\r'; return 2;
+        case 't': out[0] = '\t'; return 2;
+        case 'b': out[0] = '\b'; return 2;
+        case 'f': out[0] = '\f'; return 2;
+        default: break;
+    }
+    if (mode == ESCAPE_C) {
+        if (c == 'a') { out[0] = '\a'; return 2; }
+        if (c == 'v') { out[0] = '\v'; return 2; }
+        if (c >= '0' && c <= '7') {
+            size_t k = 1;
+            v = 0;
+            while (k < 4 && k < n && s[k] >= '0' && s[k] <= '7') v = v * 8 + (s[k++] - '0');
+            if (v > 0xFF) return 0;
+            out[0] = static_cast<char>(v);
+            return k;
+        }
+        if (c == 'x') {
+            size_t k = 2;
+            while (k < 4 && k < n && hex_value(s[k]) >= 0) ++k;
+            if (k == 2 || !hex_digits_value(s + 2, k - 2, &v)) return 0;
+            out[0] = static_cast<char>(v);
+            return k;
+        }
+        return 0;
+    }
+    // JSON \uXXXX, with surrogate pairs combined into one code point.
+    if (c != 'u' || n < 6 || !hex_digits_value(s + 2, 4, &v)) return 0;
+    size_t used = 6;
+    if (v >= 0xD800 && v < 0xDC00) {
+        uint32_t low;
+        if (n < 12 || s[6] != '\\' || s[7] != 'u' || !hex_digits_value(s + 8, 4, &low) ||
+            low < 0xDC00 || low > 0xDFFF) return 0;
+        v = 0x10000 + ((v - 0xD800) << 10) + (low - 0xDC00);
+        used = 12;
+    } else if (v >= 0xDC00 && v <= 0xDFFF) {
+        return 0;
+    }
+    *written = utf8_encode(v, out);
+    return used;
+}
+
+// Decodes s into out (which may be null to only measure). Returns the
+// decoded size, never more than n, or (size_t)-1 if s is malformed.
+inline size_t unescape_write(const char* s, size_t n, EscapeMode mode, char* out) {
+    char marker = (mode == ESCAPE_URL) ? '%' : '\\';
+    size_t i = 0, o = 0;
+    while (i < n) {
+        const char* hit = static_cast<const char*>(memchr(s + i, marker, n - i));
+        size_t clean = hit ? static_cast<size_t>(hit - (s + i)) : n - i;
+        if (out) memcpy(out + o, s + i, clean);
+        o += clean;
+        i += clean;
+        if (i == n) break;
+        char tmp[4];
+        size_t written;
+        size_t used = unescape_unit(s + i, n - i, mode, tmp, &written);
+        if (used == 0) return (size_t)-1;
+        if (out) memcpy(out + o, tmp, written);
+        o += written;
+        i += used;
+    }
+    return o;
+}
+
+// 7. Number formatting. max_chars<T>::value is the widest text a value of
+// T can produce (sign included, no terminator); all numbers are formatted
+// by hand so that numeric output does not drag in snprintf.
+template <typename T> struct max_chars {};
+#define MYSTRING_INTEGER_WIDTH(T) \
+    template <> struct max_chars<T> { static const size_t value = sizeof(T) * 241 / 100 + 2; };
+MYSTRING_INTEGER_WIDTH(bool)
+MYSTRING_INTEGER_WIDTH(signed char)
+MYSTRING_INTEGER_WIDTH(unsigned char)
+MYSTRING_INTEGER_WIDTH(short)
+MYSTRING_INTEGER_WIDTH(unsigned short)
+MYSTRING_INTEGER_WIDTH(int)
+MYSTRING_INTEGER_WIDTH(unsigned int)
+MYSTRING_INTEGER_WIDTH(long)
+MYSTRING_INTEGER_WIDTH(unsigned long)
+MYSTRING_INTEGER_WIDTH(long long)
+MYSTRING_INTEGER_WIDTH(unsigned long long)
+#undef MYSTRING_INTEGER_WIDTH
+template <> struct max_chars<char> { static const size_t value = 1; };
+// Two decimals below 1e15 ("-1000000000000000.00" after rounding); larger
+// magnitudes switch to "-1.23e+308".
+template <> struct max_chars<float> { static const size_t value = 1 + 16 + 3; };
+template <> struct max_chars<double> { static const size_t value = 1 + 16 + 3; };
+
+// SFINAE helper: only types with a max_chars width take the numeric paths.
+template <size_t Width, typename R> struct if_formattable { typedef R type; };
+
+template <typename U>
+inline char* format_decimal(char* first, char* last, U magnitude, bool negative) {
+    char tmp[max_chars<U>::value];
+    size_t n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) tmp[n++] = '-';
+    if (n > static_cast<size_t>(last - first)) return nullptr;
+    for (size_t i = 0; i < n; ++i) first[i] = tmp[n - 1 - i];
+    return first + n;
+}
+
+template <typename S, typename U>
+inline char* format_signed(char* first, char* last, S value) {
+    U magnitude = (value < 0) ? static_cast<U>(0) - static_cast<U>(value) : static_cast<U>(value);
+    return format_decimal<U>(first, last, magnitude, value < 0);
+}
+
+// Writes the text of value to [first, last) without a terminator. Returns
+// one past the last character written, or nullptr if it does not fit.
+inline char* to_chars(char* first, char* last, int value) {
+    return format_signed<int, unsigned int>(first, last, value);
+}
+inline char* to_chars(char* first, char* last, long value) {
+    return format_signed<long, unsigned long>(first, last, value);
+}
+inline char* to_chars(char* first, char* last, long long value) {
+    return format_signed<long long, unsigned long long>(first, last, value);
+}
+inline char* to_chars(char* first, char* last, unsigned int value) {
+    return format_decimal<unsigned int>(first, last, value, false);
+}
+inline char* to_chars(char* first, char* last, unsigned long value) {
+    return format_decimal<unsigned long>(first, last, value, false);
+}
+inline char* to_chars(char* first, char* last, unsigned long long value) {
+    return format_decimal<unsigned long long>(first, last, value, false);
+}
+inline char* to_chars(char* first, char* last, char c) {
+    if (first == last) return nullptr;
+    *first = c;
+    return first + 1;
+}
+// Rounding error of s = a + b, so that a + b == s + error exactly (Knuth).
+inline double two_sum_error(double a, double b, double s) {
+    double bb = s - a;
+    return (a - (s - bb)) + (b - bb);
+}
+
+// Like "%.2f" (exact ties round to even), but by hand: newlib's %f
+// allocates and AVR's default printf has none. Magnitudes of 1e15 and up
+// are written as "1.23e+20"; NaN and infinities as "nan", "inf", "-inf".
+inline char* to_chars(char* first, char* last, double value) {
+    char tmp[max_chars<double>::value];
+    size_t n = 0;
+    bool negative = value < 0 || (value == 0 && 1 / value < 0);  // -0.0 too
+    double a = negative ? -value : value;
+    if (negative) tmp[n++] = '-';
+    if (a != a) {
+        memcpy(tmp, "nan", 3);  // NaN compares false, so no sign was written
+        n = 3;
+    } else if (a - a != a - a) {
+        memcpy(tmp + n, "inf", 3);
+        n += 3;
+    } else if (a < 1e15) {
+        // Split first: the fraction is exact, and scaling only it keeps
+        // integer parts beyond 2^53 / 100 from losing their cents. f * 100
+        // is summed from exact parts (64f + 32f + 4f) with the rounding
+        // errors kept, so values such as 0.645 (really 0.64500000000000002)
+        // are not mistaken for ties.
+        uint64_t whole = static_cast<uint64_t>(a);
+        double f = a - static_cast<double>(whole);
+        double p1 = f * 64, p2 = f * 32, p3 = f * 4;
+        double s1 = p1 + p2;
+        double err = two_sum_error(p1, p2, s1);
+        double scaled = s1 + p3;
+        err += two_sum_error(s1, p3, scaled);
+        unsigned cents = static_cast<unsigned>(scaled);
+        double frac = scaled - cents;
+        if (frac > 0.499 && frac < 0.501) {
+            double above = (frac - 0.5) + err;  // exact sign of f * 100 - (cents + 0.5)
+            if (above > 0 || (above == 0 && (cents & 1))) ++cents;
+        } else if (frac > 0.5) {
+            ++cents;
+        }
+        if (cents == 100) {
+            cents = 0;
+            ++whole;
+        }
+        char* end = format_decimal<uint64_t>(tmp + n, tmp + sizeof(tmp), whole, false);
+        n = static_cast<size_t>(end - tmp);
+        tmp[n++] = '.';
+        tmp[n++] = static_cast<char>('0' + cents / 10);
+        tmp[n++] = static_cast<char>('0' + cents % 10);
+    } else {
+        int exp10 = 0;
+        for (; a >= 10; a /= 10) ++exp10;
+        unsigned units = static_cast<unsigned>(a * 100 + 0.5);
+        if (units >= 1000) {
+            units /= 10;
+            ++exp10;
+        }
+        tmp[n++] = static_cast<char>('0' + units / 100);
+        tmp[n++] = '.';
+        tmp[n++] = static_cast<char>('0' + units / 10 % 10);
+        tmp[n++] = static_cast<char>('0' + units % 10);
+        tmp[n++] = 'e';
+        tmp[n++] = '+';
+        if (exp10 >= 100) tmp[n++] = static_cast<char>('0' + exp10 / 100);
+        tmp[n++] = static_cast<char>('0' + exp10 / 10 % 10);
+        tmp[n++] = static_cast<char>('0' + exp10 % 10);
+    }
+    if (n > static_cast<size_t>(last - first)) return nullptr;
+    memcpy(first, tmp, n);
+    return first + n;
+}
+inline char* to_chars(char* first, char* last, float value) {
+    return to_chars(first, last, static_cast<double>(value));
+}
+
+class Sink;
+class string;
+
+// Length of a const char array: N - 1 for a literal, found without a scan,
+// or up to the first NUL for a sized array with spare room
+// (static const char name[16] = "wifi"). Unlike strlen, a literal with an
+// embedded NUL ("ab\0cd") keeps the bytes after it.
+MYSTRING_CONSTEXPR14 inline size_t array_text_len(const char* s, size_t n) {
+    if (n == 0) return 0;
+    if (s[n - 1] == '\0' && (n == 1 || s[n - 2] != '\0')) return n - 1;
+    size_t len = 0;
+    while (len < n - 1 && s[len] != '\0') ++len;
+    return len;
+}
+
+// Selects the const char* / char* overloads while letting string literals
+// bind to the (const char (&)[N]) overloads. Writable char arrays are
+// treated as buffers and measured.
+template <typename T, typename R> struct enable_if_cstr {};
+template <typename R> struct enable_if_cstr<const char*, R> { typedef R type; };
+template <typename R> struct enable_if_cstr<char*, R> { typedef R type; };
+
+// Smallest unsigned type that can hold Max, for offsets and lengths in
+// fixed-size tables.
+template <size_t Max, int Bytes = (Max <= 0xFFu) ? 1 : (Max <= 0xFFFFu) ? 2
+                                : (Max <= 0xFFFFFFFFu) ? 4 : 8>
+struct uint_for;
+template <size_t Max> struct uint_for<Max, 1> { typedef uint8_t type; };
+template <size_t Max> struct uint_for<Max, 2> { typedef uint16_t type; };
+template <size_t Max> struct uint_for<Max, 4> { typedef uint32_t type; };
+template <size_t Max> struct uint_for<Max, 8> { typedef uint64_t type; };
+
 class string_view { 
 protected:
     const char* m_data; 
@@ -43,7 +753,12 @@ protected:
 
 public:
     string_view() : m_data(nullptr), m_len(0) {}
-    string_view(const char* data) : m_data(data) {
+    template <size_t N>
+    string_view(const char (&literal)[N]) : m_data(literal), m_len(array_text_len(literal, N)) {}
+    template <size_t N>
+    string_view(char (&buf)[N]) : m_data(buf), m_len(strlen(buf)) {}
+    template <typename T, typename = typename enable_if_cstr<T, void>::type>
+    string_view(const T& data) : m_data(data) {
         m_len = (data) ? strlen(data) : 0;
     }
     string_view(const char* data, size_t len) : m_data(data), m_len(len) {}
@@ -87,7 +802,7 @@ public:
         return 0;
     }
 
-    // 5. Safely handle C++20 spaceship vs C++11 standard operators
+    // 8. Safely handle C++20 spaceship vs C++11 standard operators
     #if __cplusplus >= 202002L
     std::strong_ordering operator<=>(const string_view& other) const {
         const char* d1 = m_data ? m_data : "";
@@ -107,10 +822,16 @@ public:
     bool operator>=(const string_view& other) const { return compare(other) >= 0; }
     #endif
 
-    bool operator==(const string_view& other) const { return compare(other) == 0; }
-    bool operator!=(const string_view& other) const { return compare(other) != 0; }
-    bool operator==(const char* str) const { return compare(string_view(str)) == 0; }
-    bool operator!=(const char* str) const { return compare(string_view(str)) != 0; }
+    // Lengths are compared first, so a mismatch such as str == "status"
+    // against a 3-byte string costs no memcmp at all.
+    bool operator==(const string_view& other) const {
+        if (m_len != other.m_len) return false;
+        return m_len == 0 || memcmp(m_data, other.m_data, m_len) == 0;
+    }
+    bool operator!=(const string_view& other) const { return !(*this == other); }
+    // A null pointer compares equal to an empty view, as a null const char* does.
+    bool operator==(decltype(nullptr)) const { return m_len == 0; }
+    bool operator!=(decltype(nullptr)) const { return m_len != 0; }
 
     int indexOf(char c) const {
         for (size_t i = 0; i < m_len; ++i) {
@@ -129,10 +850,6 @@ public:
         return memcmp(d1, d2, prefix.m_len) == 0;
     }
 
-    bool startsWith(const char* prefix) const {
-        return startsWith(string_view(prefix));
-    }
-
     int find(const string_view& substr) const {
         if (substr.m_len == 0) return 0;
         if (substr.m_len > m_len) return -1;
@@ -148,118 +865,235 @@ public:
         return -1;
     }
 
-    int find(const char* substr) const {
-        return find(string_view(substr));
+    static const size_t npos = (size_t)-1;
+
+    // Views into the same bytes; nothing is copied, so they are only valid
+    // while the underlying data is. Out-of-range positions are clamped.
+    string_view substr(size_t pos, size_t count = npos) const {
+        if (pos > m_len) pos = m_len;
+        size_t rest = m_len - pos;
+        return string_view(m_data + pos, count < rest ? count : rest);
+    }
+
+    // [begin, end), like a Python slice without negative indices.
+    string_view slice(size_t begin, size_t end) const {
+        if (end > m_len) end = m_len;
+        if (begin > end) begin = end;
+        return string_view(m_data + begin, end - begin);
+    }
+
+    // Return the view without its first/last n bytes; this view is unchanged.
+    string_view removePrefix(size_t n) const { return substr(n); }
+    string_view removeSuffix(size_t n) const { return substr(0, n < m_len ? m_len - n : 0); }
+
+    bool isValidUtf8() const {
+        size_t i = 0;
+        while (i < m_len) {
+            i += utf8_ascii_prefix(m_data + i, m_len - i);
+            if (i == m_len) break;
+            uint32_t cp;
+            size_t n = utf8_decode(m_data + i, m_len - i, &cp);
+            if (n == 0) return false;
+            i += n;
+        }
+        return true;
+    }
+
+    // Counts lead bytes, so each invalid byte counts as one codepoint.
+    size_t codepointCount() const {
+        size_t continuation = 0;
+        size_t i = 0;
+        for (; i + sizeof(utf8_word) <= m_len; i += sizeof(utf8_word)) {
+            utf8_word w = utf8_load(m_data + i);
+            utf8_word cont = (w & ~(w << 1)) & UTF8_HIGH_BITS;
+            continuation += (size_t)(((cont >> 7) * ((utf8_word)~(utf8_word)0 / 0xFF))
+                                     >> ((sizeof(utf8_word) - 1) * 8));
+        }
+        for (; i < m_len; ++i) {
+            if ((m_data[i] & 0xC0) == 0x80) ++continuation;
+        }
+        return m_len - continuation;
+    }
+
+    utf8_range codepoints() const {
+        utf8_range r = { m_data, m_data + m_len };
+        return r;
     }
 
     void print() const {
         if (m_data) {
             #if defined(ARDUINO)
             Serial.write((const uint8_t*)m_data, m_len);
-            #else
+            #elif defined(MYSTRING_HAS_IOSTREAM)
             std::cout.write(m_data, m_len);
+            #else
+            fwrite(m_data, 1, m_len, stdout);
             #endif
         }
     }
+
+    // Decodes hex/Base64 text into out. Returns the number of bytes written,
+    // or -1 if the text is malformed or out_cap is too small.
+    int decodeHex(uint8_t* out, size_t out_cap) const {
+        if (m_len / 2 > out_cap) return -1;
+        if (!hex_decode(m_data, m_len, out)) return -1;
+        return static_cast<int>(m_len / 2);
+    }
+
+    int decodeBase64(uint8_t* out, size_t out_cap) const {
+        size_t n = base64_decoded_size(m_data, m_len);
+        if (n == (size_t)-1 || n > out_cap) return -1;
+        if (!base64_decode(m_data, m_len, out)) return -1;
+        return static_cast<int>(n);
+    }
+
+    // Appends the decoded bytes to out (e.g. a FixedString). Defined below string.
+    bool decodeHex(string& out) const;
+    bool decodeBase64(string& out) const;
+
+    // Stages the view in a buffered sink instead of writing it immediately.
+    // Defined in mystring_sink.hpp.
+    void print(Sink& sink) const;
+
+    // Levenshtein distance, or -1 once it is known to exceed max_dist; and
+    // the start of the closest approximate occurrence of pattern (at most
+    // max_dist edits), or -1. Patterns up to 64 bytes. Defined in
+    // mystring_fuzzy.hpp.
+    int editDistance(const string_view& other, size_t max_dist) const;
+    int fuzzyFind(const string_view& pattern, size_t max_dist, size_t* match_len = nullptr) const;
 };
 
+enum TruncateMode { TRUNCATE_BYTES, TRUNCATE_UTF8 };
+
 class string : public string_view {
     protected:
-        char* buffer;
         size_t capacity_; 
-        bool m_owns_memory;
+        bool m_owns_memory : 1;
+        bool m_utf8_truncate : 1;
+        bool m_terminated : 1;
+
+        // The text lives at m_data; a string always owns or was handed a
+        // writable buffer, so the view pointer doubles as the buffer pointer.
+        char* buf() const { return const_cast<char*>(m_data); }
 
-        void sync_view() { m_data = buffer; }
+        // Adopted buffers may have no room for the terminator.
+        void terminate() { if (m_terminated) buf()[m_len] = '\0'; }
+
+        // How many bytes of str fit into room, honouring the truncation mode.
+        size_t fit_len(const char* str, size_t str_len, size_t room) const {
+            if (str_len <= room) return str_len;
+            return m_utf8_truncate ? utf8_safe_cut(str, str_len, room) : room;
+        }
 
         char* append_impl(const char* str, size_t str_len) {
             size_t available_space = capacity_ - m_len;
-            size_t to_copy = (str_len < available_space) ? str_len : available_space;
+            size_t to_copy = fit_len(str, str_len, available_space);
             
             if (str_len > available_space) {
                 PRINT_WARNING("WARNING: Truncating string append.");
             }
             
-            memcpy(buffer + m_len, str, to_copy);
+            memcpy(buf() + m_len, str, to_copy);
             m_len += to_copy;
-            buffer[m_len] = '\0';
+            terminate();
             
-            sync_view();
-            return buffer;
+            return buf();
         }
 
         string(size_t cap, char* buf)
-            : string_view(buf, 0), buffer(buf), capacity_(cap), m_owns_memory(false) {
-            buffer[0] = '\0';
+            : string_view(buf, 0), capacity_(cap), m_owns_memory(false), m_utf8_truncate(false), m_terminated(true) {
+            buf[0] = '\0';
+        }
+
+        // Adopts buf with its current contents; see BufferString.
+        string(char* buf, size_t cap, size_t len, bool terminated)
+            : string_view(buf, len), capacity_(cap), m_owns_memory(false), m_utf8_truncate(false), m_terminated(terminated) {
+            terminate();
         }
 
         static size_t calc_min_cap(size_t req) { return (req < 8) ? 8 : req; }
 
+        bool append_escaped(const string_view& text, EscapeMode mode) {
+            size_t need = escaped_size(text.data(), text.size(), mode);
+            size_t room = prepare_append(need);
+            size_t consumed;
+            commit_append(escape_write(text.data(), text.size(), mode, buf() + m_len, room, &consumed));
+            if (consumed < text.size()) {
+                PRINT_WARNING("WARNING: Truncating escaped append.");
+                return false;
+            }
+            return true;
+        }
+
+        bool append_unescaped(const string_view& text, EscapeMode mode) {
+            size_t need = unescape_write(text.data(), text.size(), mode, nullptr);
+            if (need == (size_t)-1 || prepare_append(need) < need) return false;
+            commit_append(unescape_write(text.data(), text.size(), mode, buf() + m_len));
+            return true;
+        }
+
     public:
-        const char *c_str() const { return buffer; };  
-        char* data() { return buffer; }
+        const char *c_str() const { return buf(); };  
+        char* data() { return buf(); }
         size_t capacity() const { return capacity_; };
 
-        string(const char *cstr) 
-            : string_view(nullptr, 0), capacity_(0), m_owns_memory(true) 
-        {
-            size_t len = (cstr) ? strlen(cstr) : 0;
-            capacity_ = calc_min_cap(len);
-            
-            buffer = new char[capacity_ + 1];
-            if (len > 0) memcpy(buffer, cstr, len);
-            m_len = len;
-            buffer[m_len] = '\0';
-            sync_view();
-        }
+        // TRUNCATE_UTF8 backs off to the previous character boundary instead
+        // of cutting a multi-byte sequence in half when a write overflows.
+        void setTruncateMode(TruncateMode mode) { m_utf8_truncate = (mode == TRUNCATE_UTF8); }
+        TruncateMode truncateMode() const { return m_utf8_truncate ? TRUNCATE_UTF8 : TRUNCATE_BYTES; }
+
+        template <size_t N>
+        string(const char (&literal)[N]) : string(literal, array_text_len(literal, N)) {}
+        template <size_t N>
+        string(char (&buf)[N]) : string(buf, strlen(buf)) {}
+        template <typename T, typename = typename enable_if_cstr<T, void>::type>
+        string(const T& cstr) : string(cstr, (cstr) ? strlen(cstr) : 0) {}
 
         string(const char *data, size_t size) 
-            : string_view(nullptr, 0), capacity_(calc_min_cap(size)), m_owns_memory(true) 
+            : string_view(nullptr, 0), capacity_(calc_min_cap(size)), m_owns_memory(true), m_utf8_truncate(false), m_terminated(true) 
         {
-            buffer = new char[capacity_ + 1];
-            if (size > 0 && data) memcpy(buffer, data, size);
+            m_data = new char[capacity_ + 1];
+            if (size > 0 && data) memcpy(buf(), data, size);
             m_len = size;
-            buffer[m_len] = '\0';
-            sync_view();
+            buf()[m_len] = '\0';
         }
 
         string(const string_view& sv) 
-            : string_view(nullptr, 0), capacity_(calc_min_cap(sv.size())), m_owns_memory(true) 
+            : string_view(nullptr, 0), capacity_(calc_min_cap(sv.size())), m_owns_memory(true), m_utf8_truncate(false), m_terminated(true) 
         {
-            buffer = new char[capacity_ + 1];
-            if (sv.size() > 0) memcpy(buffer, sv.data(), sv.size());
+            m_data = new char[capacity_ + 1];
+            if (sv.size() > 0) memcpy(buf(), sv.data(), sv.size());
             m_len = sv.size();
-            buffer[m_len] = '\0';
-            sync_view();
+            buf()[m_len] = '\0';
         }
 
         string(const string& other) 
-            : string_view(nullptr, 0), buffer(nullptr), capacity_(calc_min_cap(other.capacity_)), m_owns_memory(true)
+            : string_view(nullptr, 0), capacity_(calc_min_cap(other.capacity_)), m_owns_memory(true), m_utf8_truncate(false), m_terminated(true)
         {
-            buffer = new char[capacity_ + 1];    
+            m_data = new char[capacity_ + 1];    
             size_t to_copy = (other.m_len < capacity_) ? other.m_len : capacity_;
-            if (to_copy > 0) memcpy(buffer, other.buffer, to_copy);
+            if (to_copy > 0) memcpy(buf(), other.m_data, to_copy);
             m_len = to_copy;
-            buffer[m_len] = '\0';
-            sync_view();
+            buf()[m_len] = '\0';
         }
 
         string(string&& other) noexcept
-            : string_view(nullptr, 0), buffer(nullptr), capacity_(0), m_owns_memory(false)
+            : string_view(nullptr, 0), capacity_(0), m_owns_memory(false), m_utf8_truncate(false), m_terminated(true)
         {
             *this = static_cast<string&&>(other);
         }
 
         string& operator=(string&& other) noexcept {
             if (this != &other) {
-                if (m_owns_memory && buffer) delete[] buffer;
+                if (m_owns_memory && buf()) delete[] buf();
                 
-                buffer = other.buffer;
+                m_data = other.m_data;
                 capacity_ = other.capacity_;
                 m_owns_memory = other.m_owns_memory;
-                m_data = buffer;
+                m_utf8_truncate = other.m_utf8_truncate;
+                m_terminated = other.m_terminated;
                 m_len = other.m_len;
 
-                other.buffer = nullptr;
                 other.m_data = nullptr;
                 other.m_len = 0;
                 other.capacity_ = 0;
@@ -270,64 +1104,191 @@ class string : public string_view {
 
         #ifdef HAS_STL_STRING
         string(const std::string& std_str) 
-        : string_view(nullptr, 0), capacity_(calc_min_cap(std_str.length())), m_owns_memory(true) 
+        : string_view(nullptr, 0), capacity_(calc_min_cap(std_str.length())), m_owns_memory(true), m_utf8_truncate(false), m_terminated(true) 
         {
-            buffer = new char[capacity_ + 1];
-            if (!std_str.empty()) memcpy(buffer, std_str.data(), std_str.length());
+            m_data = new char[capacity_ + 1];
+            if (!std_str.empty()) memcpy(buf(), std_str.data(), std_str.length());
             m_len = std_str.length();
-            buffer[m_len] = '\0';
-            sync_view();
+            buf()[m_len] = '\0';
         }
         operator std::string() const {
-            if (!buffer || m_len == 0) return std::string();
-            return std::string(buffer, m_len);
+            if (!buf() || m_len == 0) return std::string();
+            return std::string(buf(), m_len);
         }
         #endif
 
         #if defined(ARDUINO)
         string(const String& ard_str)
-            : string_view(nullptr, 0), capacity_(calc_min_cap(ard_str.length())), m_owns_memory(true)
+            : string_view(nullptr, 0), capacity_(calc_min_cap(ard_str.length())), m_owns_memory(true), m_utf8_truncate(false), m_terminated(true)
         {
-            buffer = new char[capacity_ + 1];
-            if (ard_str.length() > 0) memcpy(buffer, ard_str.c_str(), ard_str.length());
+            m_data = new char[capacity_ + 1];
+            if (ard_str.length() > 0) memcpy(buf(), ard_str.c_str(), ard_str.length());
             m_len = ard_str.length();
-            buffer[m_len] = '\0';
-            sync_view();
+            buf()[m_len] = '\0';
         }
         operator String() const {
-            return String(buffer);
+            return String(buf());
         }
         #endif
 
         virtual ~string() {
-            if (m_owns_memory && buffer != nullptr) {
-                delete[] buffer;
+            if (m_owns_memory && buf() != nullptr) {
+                delete[] buf();
+            }
+        }
+
+        void clear() { m_len = 0; terminate(); }
+
+        // Drops everything from new_len on; longer lengths are ignored.
+        void truncate(size_t new_len) {
+            if (new_len >= m_len) return;
+            m_len = new_len;
+            terminate();
+        }
+
+        // Direct writes into spare capacity, for producers that know their
+        // output size (encoders, read(2)). prepare_append() makes room for
+        // extra bytes, growing through reserve(), and returns how many fit;
+        // write them at data() + size(), then commit_append() the count.
+        size_t prepare_append(size_t extra) {
+            if (extra > capacity_ - m_len) reserve(m_len + extra);
+            size_t room = capacity_ - m_len;
+            return (extra < room) ? extra : room;
+        }
+
+        void commit_append(size_t written) {
+            m_len += written;
+            terminate();
+        }
+
+        // Fixed-capacity strings can only report whether min_capacity fits;
+        // DynamicString grows.
+        virtual bool reserve(size_t min_capacity) { return min_capacity <= capacity_; }
+
+        // Encoded output is sized once and written in bulk. When it does not
+        // fit, whole input bytes/groups are encoded up to the capacity and
+        // false is returned.
+        bool appendHex(const void* data, size_t len, bool uppercase = false) {
+            size_t room = prepare_append(hex_encoded_size(len));
+            size_t n = room / 2;
+            hex_encode(static_cast<const uint8_t*>(data), n, buf() + m_len, uppercase);
+            commit_append(n * 2);
+            if (n < len) {
+                PRINT_WARNING("WARNING: Truncating hex append.");
+                return false;
+            }
+            return true;
+        }
+
+        bool appendHex(const string_view& bytes, bool uppercase = false) {
+            return appendHex(bytes.data(), bytes.size(), uppercase);
+        }
+
+        bool appendBase64(const void* data, size_t len) {
+            size_t room = prepare_append(base64_encoded_size(len));
+            size_t n = (room == base64_encoded_size(len)) ? len : room / 4 * 3;
+            base64_encode(static_cast<const uint8_t*>(data), n, buf() + m_len);
+            commit_append(base64_encoded_size(n));
+            if (n < len) {
+                PRINT_WARNING("WARNING: Truncating base64 append.");
+                return false;
             }
+            return true;
+        }
+
+        bool appendBase64(const string_view& bytes) {
+            return appendBase64(bytes.data(), bytes.size());
         }
 
-        char& operator[](size_t index) { return buffer[index]; }
+        // Escaped output is measured once, reserved once, and clean runs are
+        // copied with one memcpy each. When it does not fit, whole escapes
+        // are written up to the capacity and false is returned.
+        bool appendUrlEncoded(const string_view& text) { return append_escaped(text, ESCAPE_URL); }
+        bool appendJsonEscaped(const string_view& text) { return append_escaped(text, ESCAPE_JSON); }
+        bool appendCEscaped(const string_view& text) { return append_escaped(text, ESCAPE_C); }
+
+        // The decoders append the unescaped text. Malformed input, or a result
+        // that does not fit, leaves the string unchanged and returns false.
+        // '+' is not treated as a space by appendUrlDecoded.
+        bool appendUrlDecoded(const string_view& text) { return append_unescaped(text, ESCAPE_URL); }
+        bool appendJsonUnescaped(const string_view& text) { return append_unescaped(text, ESCAPE_JSON); }
+        bool appendCUnescaped(const string_view& text) { return append_unescaped(text, ESCAPE_C); }
+
+        // Inserts text before pos, shifting the tail with one memmove.
+        // Grows through reserve() (DynamicString) when needed; returns false
+        // and leaves the string untouched if pos is past the end or the
+        // result does not fit. text may be a view into this string.
+        bool insert(size_t pos, const string_view& text) {
+            size_t n = text.size();
+            if (pos > m_len) return false;
+            if (n == 0) return true;
+
+            // Remember where a self-referencing source sits, since reserve()
+            // may move the buffer.
+            const char* src = text.data();
+            bool self = src >= buf() && src < buf() + m_len;
+            size_t src_off = self ? static_cast<size_t>(src - buf()) : 0;
+            if (n > capacity_ - m_len && !reserve(m_len + n)) {
+                PRINT_WARNING("WARNING: insert does not fit.");
+                return false;
+            }
+            if (self) src = buf() + src_off;
+
+            memmove(buf() + pos + n, buf() + pos, m_len - pos);
+            if (!self || src_off + n <= pos) {
+                memcpy(buf() + pos, src, n);
+            } else if (src_off >= pos) {
+                memcpy(buf() + pos, src + n, n);
+            } else {
+                size_t head = pos - src_off;  // source straddles the gap
+                memcpy(buf() + pos, src, head);
+                memcpy(buf() + pos + head, buf() + pos + n, n - head);
+            }
+            m_len += n;
+            terminate();
+            return true;
+        }
+
+        // Removes up to count bytes starting at pos; false if pos is past the end.
+        bool erase(size_t pos, size_t count = npos) {
+            if (pos > m_len) return false;
+            size_t rest = m_len - pos;
+            if (count > rest) count = rest;
+            memmove(buf() + pos, buf() + pos + count, rest - count);
+            m_len -= count;
+            terminate();
+            return true;
+        }
+
+        char& operator[](size_t index) { return buf()[index]; }
 
         char& at(size_t index) {
             if (index >= m_len) {
                 PRINT_WARNING("ERROR: Index out of bounds!");
-                return buffer[m_len > 0 ? m_len - 1 : 0]; 
+                return buf()[m_len > 0 ? m_len - 1 : 0]; 
             }
-            return buffer[index];
+            return buf()[index];
         }
 
-        string& operator=(const char* str) {
+        template <size_t N>
+        string& operator=(const char (&literal)[N]) { return assign(literal, array_text_len(literal, N)); }
+        template <size_t N>
+        string& operator=(char (&buf)[N]) { return assign(buf, strlen(buf)); }
+        template <typename T>
+        typename enable_if_cstr<T, string&>::type operator=(const T& str) {
             if (str == nullptr) {
-                m_len = 0; buffer[0] = '\0'; sync_view(); return *this;
+                m_len = 0; terminate(); return *this;
             }
+            return assign(str, strlen(str));
+        }
+
+        string& assign(const char* str, size_t str_len) {
+            size_t to_copy = fit_len(str, str_len, capacity_);
             
-            size_t str_len = strlen(str);
-            size_t to_copy = (str_len < capacity_) ? str_len : capacity_;
-            
-            if (buffer) {
-                memcpy(buffer, str, to_copy);
+            if (buf()) {
+                memcpy(buf(), str, to_copy);
                 m_len = to_copy;
-                buffer[m_len] = '\0';
-                sync_view();
+                terminate();
             } else {
                 PRINT_WARNING("CRITICAL ERROR: Buffer is NULL in operator=");
             }
@@ -336,75 +1297,109 @@ class string : public string_view {
 
         string& operator=(const string& other) {
             if (this != &other) {
-                size_t to_copy = (other.m_len < capacity_) ? other.m_len : capacity_;
-                memcpy(buffer, other.buffer, to_copy);
+                size_t to_copy = fit_len(other.m_data, other.m_len, capacity_);
+                memcpy(buf(), other.m_data, to_copy);
                 m_len = to_copy;
-                buffer[m_len] = '\0';
-                sync_view();
+                terminate();
             }
             return *this;
         }
 
         virtual bool concat(const char c) { return append_impl(&c, 1) != nullptr; }
-        virtual bool concat(const char* str) { 
-            if (!str) return false;
-            return append_impl(str, strlen(str)) != nullptr; 
-        }
         virtual bool concat(const string_view& sv) { 
             return append_impl(sv.data(), sv.size()) != nullptr; 
         }
+        // Literals bind here too (an exact match beats the conversion to
+        // string_view), so they are measured; subclasses that override this
+        // keep being called. The text goes on through concat(string_view).
+        virtual bool concat(const char* str) {
+            if (!str) return false;
+            return concat(string_view(str, strlen(str)));
+        }
         virtual bool concat(int num) {
-            char num_str[12];
-            int len = snprintf(num_str, sizeof(num_str), "%d", num);
-            if (len < 0) return false;
-            return concat(string_view(num_str, len)); 
+            char num_str[max_chars<int>::value];
+            char* end = to_chars(num_str, num_str + sizeof(num_str), num);
+            return concat(string_view(num_str, end - num_str)); 
         }
         virtual bool concat(float num) {
-            char num_str[32];
-            int len = snprintf(num_str, sizeof(num_str), "%.2f", num); 
-            if (len < 0) return false;
-            return concat(string_view(num_str, len));
+            char num_str[max_chars<float>::value];
+            char* end = to_chars(num_str, num_str + sizeof(num_str), num);
+            if (!end) return false;
+            return concat(string_view(num_str, end - num_str));
         }
 
         bool operator+=(const string& other) { return concat(other); }
-        
+
+        // Same as concat(const char*): forwards to the string_view overload.
         virtual bool replace(const char* old_str, const char* new_str) {
             if (!old_str || !new_str) return false;
+            return replace(string_view(old_str, strlen(old_str)), string_view(new_str, strlen(new_str)));
+        }
+
+        virtual bool replace(const string_view& old_str, const string_view& new_str) {
+            if (!old_str.data() || !new_str.data() || old_str.size() == 0) return false;
             int index = find(old_str);
             if (index == -1) return false;
 
-            size_t old_len = strlen(old_str);
-            size_t new_len = strlen(new_str);
+            size_t old_len = old_str.size();
+            size_t new_len = new_str.size();
             size_t new_total_len = m_len - old_len + new_len;
             
             if (new_total_len > capacity_) return false; 
 
-            char* match_start = buffer + index;
+            char* match_start = buf() + index;
             char* tail_start = match_start + old_len;
             size_t tail_len = m_len - (index + old_len);
             
             memmove(match_start + new_len, tail_start, tail_len);
-            memcpy(match_start, new_str, new_len);
+            memcpy(match_start, new_str.data(), new_len);
             
             m_len = new_total_len;
-            buffer[m_len] = '\0';
-            sync_view();      
+            terminate();
             return true;
         }
 };
 
-string to_string(int num) {
-    char num_str[12];
-    snprintf(num_str, sizeof(num_str), "%d", num);
-    return string(num_str);
+inline bool string_view::decodeHex(string& out) const {
+    size_t n = m_len / 2;
+    if ((m_len & 1) || out.reserve(out.size() + n) == false) return false;
+    bool ok = hex_decode(m_data, m_len, reinterpret_cast<uint8_t*>(out.data() + out.size()));
+    out.commit_append(ok ? n : 0);
+    return ok;
 }
-string to_string(float num) {
-    char num_str[32];
-    snprintf(num_str, sizeof(num_str), "%.2f", num); 
-    return string(num_str); 
+
+inline bool string_view::decodeBase64(string& out) const {
+    size_t n = base64_decoded_size(m_data, m_len);
+    if (n == (size_t)-1 || !out.reserve(out.size() + n)) return false;
+    bool ok = base64_decode(m_data, m_len, reinterpret_cast<uint8_t*>(out.data() + out.size()));
+    out.commit_append(ok ? n : 0);
+    return ok;
+}
+
+inline string to_string(int num) {
+    char num_str[max_chars<int>::value];
+    char* end = to_chars(num_str, num_str + sizeof(num_str), num);
+    return string(num_str, end - num_str);
+}
+inline string to_string(float num) {
+    char num_str[max_chars<float>::value];
+    char* end = to_chars(num_str, num_str + sizeof(num_str), num);
+    return string(num_str, end ? end - num_str : 0); 
+}
+inline string to_string(const string_view& str) { return string(str); }
+inline string to_string(const char c) { return string(&c, 1); }
+
+// Heap-free conversions: append the text of value to an existing string.
+// Returns false if the string had to truncate it.
+template <typename T>
+typename if_formattable<max_chars<T>::value, bool>::type to_chars(string& out, T value) {
+    char tmp[max_chars<T>::value];
+    char* end = to_chars(tmp, tmp + sizeof(tmp), value);
+    if (!end) return false;
+    size_t before = out.size();
+    out.concat(string_view(tmp, end - tmp));
+    return out.size() == before + static_cast<size_t>(end - tmp);
 }
-string to_string(const char* str) { return string(str); }
-string to_string(const char c) { char str[2] = {c, '\0'}; return string(str); }
 
 template <size_t N>
 class FixedString : public string {
@@ -421,37 +1416,190 @@ class FixedString : public string {
             return *this;
         }
 
-        FixedString(const char* str) : string(N, storage) {
+        template <size_t M>
+        FixedString(const char (&literal)[M]) : string(N, storage) {
+            string::operator=(literal);
+        }
+        template <size_t M>
+        FixedString(char (&buf)[M]) : string(N, storage) {
+            string::operator=(buf);
+        }
+        template <typename T, typename = typename enable_if_cstr<T, void>::type>
+        FixedString(const T& str) : string(N, storage) {
             string::operator=(str); 
         }
 
-        FixedString(const char* buffer, size_t len) : string(N, storage) {
-            size_t to_copy = (len < N) ? len : N;
+        template <size_t M>
+        FixedString& operator=(const char (&literal)[M]) { string::operator=(literal); return *this; }
+        template <size_t M>
+        FixedString& operator=(char (&buf)[M]) { string::operator=(buf); return *this; }
+        template <typename T>
+        typename enable_if_cstr<T, FixedString&>::type operator=(const T& str) {
+            string::operator=(str);
+            return *this;
+        }
+
+        FixedString(const char* buffer, size_t len, TruncateMode mode = TRUNCATE_BYTES)
+            : string(N, storage) {
+            setTruncateMode(mode);
+            size_t to_copy = buffer ? fit_len(buffer, len, N) : 0;
             if (len > N) {
                 PRINT_WARNING("WARNING: Truncating string initialization.");
             }
-            if (buffer && to_copy > 0) {
+            if (to_copy > 0) {
                 memcpy(storage, buffer, to_copy);
             }
             storage[to_copy] = '\0';
             m_len = to_copy;
-            sync_view();
         }
+
+        // Known at compile time, unlike string::capacity().
+        static constexpr size_t capacity() { return N; }
         
     private:
         char storage[N+1];
 };
 
+// to_fixed(value) returns a FixedString just wide enough for any value of
+// the type; to_fixed<N>(value) picks the capacity explicitly.
+template <typename T>
+FixedString<max_chars<T>::value> to_fixed(T value) {
+    FixedString<max_chars<T>::value> out;
+    to_chars(out, value);
+    return out;
+}
+
+template <size_t N, typename T>
+typename if_formattable<max_chars<T>::value, FixedString<N> >::type to_fixed(T value) {
+    FixedString<N> out;
+    to_chars(out, value);
+    return out;
+}
+
+template <size_t N>
+FixedString<N> to_fixed(const string_view& str) {
+    return FixedString<N>(str.data(), str.size());
+}
+
+enum BufferTermination { BUFFER_TERMINATED, BUFFER_UNTERMINATED };
+
+// string semantics over a caller-owned buffer (a DMA or static receive
+// buffer), edited in place and never freed. buf_size is the full size of
+// the buffer: with BUFFER_TERMINATED one byte is kept for the '\0', with
+// BUFFER_UNTERMINATED all of it holds text and c_str() must not be used.
+class BufferString : public string {
+    static size_t text_capacity(size_t buf_size, BufferTermination term) {
+        if (term == BUFFER_UNTERMINATED) return buf_size;
+        return buf_size > 0 ? buf_size - 1 : 0;
+    }
+
+    public:
+        BufferString(char* buf, size_t buf_size, size_t len = 0, BufferTermination term = BUFFER_TERMINATED)
+            : string(buf, text_capacity(buf_size, term),
+                     len < text_capacity(buf_size, term) ? len : text_capacity(buf_size, term),
+                     term == BUFFER_TERMINATED && buf_size > 0) {
+            if (len > capacity_) {
+                PRINT_WARNING("WARNING: BufferString length exceeds its buffer.");
+            }
+        }
+
+        // Two views owning the same bytes would edit each other; copy the
+        // contents instead with assignment.
+        BufferString(const BufferString&) = delete;
+
+        BufferString& operator=(const BufferString& other) {
+            if (this != &other) {
+                string::operator=(other);
+            }
+            return *this;
+        }
+
+        template <size_t M>
+        BufferString& operator=(const char (&literal)[M]) { string::operator=(literal); return *this; }
+        template <size_t M>
+        BufferString& operator=(char (&buf)[M]) { string::operator=(buf); return *this; }
+        template <typename T>
+        typename enable_if_cstr<T, BufferString&>::type operator=(const T& str) {
+            string::operator=(str);
+            return *this;
+        }
+
+        bool isTerminated() const { return m_terminated; }
+};
+
+// Packed fixed-capacity string for arrays and tables of short text: no
+// vtable, no pointers, and a length only as wide as N needs, so
+// sizeof(CompactString<N>) is N + 2 up to N = 255 instead of N + 1 plus a
+// FixedString's ~40-byte header. It is trivially copyable and converts to
+// string_view for every read-only operation; writes truncate like
+// FixedString. Use FixedString where a string& is needed.
+template <size_t N>
+class CompactString {
+    typedef typename uint_for<N>::type length_type;
+
+    char m_text[N + 1];
+    length_type m_len;
+
+    public:
+        CompactString() : m_len(0) { m_text[0] = '\0'; }
+        CompactString(const string_view& str) : m_len(0) { assign(str); }
+
+        CompactString& operator=(const string_view& str) { assign(str); return *this; }
+
+        // Returns false if str had to be truncated.
+        bool assign(const string_view& str) {
+            m_len = 0;
+            return concat(str);
+        }
+
+        bool concat(const string_view& str) {
+            size_t room = N - m_len;
+            size_t n = str.size() < room ? str.size() : room;
+            memcpy(m_text + m_len, str.data(), n);
+            m_len = static_cast<length_type>(m_len + n);
+            m_text[m_len] = '\0';
+            if (n < str.size()) {
+                PRINT_WARNING("WARNING: Truncating string append.");
+                return false;
+            }
+            return true;
+        }
+
+        bool concat(char c) { return concat(string_view(&c, 1)); }
+
+        void clear() { m_len = 0; m_text[0] = '\0'; }
+
+        size_t size() const { return m_len; }
+        static constexpr size_t capacity() { return N; }
+        const char* c_str() const { return m_text; }
+        char* data() { return m_text; }
+
+        string_view view() const { return string_view(m_text, m_len); }
+        operator string_view() const { return view(); }
+
+        bool operator==(const string_view& other) const { return view() == other; }
+        bool operator!=(const string_view& other) const { return view() != other; }
+};
+
+static_assert(sizeof(CompactString<7>) == 9, "CompactString<7> must pack into 9 bytes");
+static_assert(sizeof(CompactString<255>) == 257, "one length byte up to 255");
+static_assert(sizeof(string) <= 2 * sizeof(void*) + 3 * sizeof(size_t),
+              "string header is vptr, data, length, capacity and one word of flags");
+
 class DynamicString : public string {
     public:
         explicit DynamicString(size_t initial_capacity) 
             : string(calc_min_cap(initial_capacity), new char[calc_min_cap(initial_capacity) + 1]) {
             m_owns_memory = true;
-            buffer[0] = '\0';
-            sync_view();
+            buf()[0] = '\0';
         }
 
-        DynamicString(const char* cstr) : string(cstr) {}
+        template <size_t N>
+        DynamicString(const char (&literal)[N]) : string(literal) {}
+        template <size_t N>
+        DynamicString(char (&buf)[N]) : string(buf) {}
+        template <typename T, typename = typename enable_if_cstr<T, void>::type>
+        DynamicString(const T& cstr) : string(cstr) {}
 
         DynamicString(const DynamicString& other) 
             : string(calc_min_cap(other.capacity()), new char[calc_min_cap(other.capacity()) + 1]) { 
@@ -475,6 +1623,11 @@ class DynamicString : public string {
             return *this;
         }
 
+        bool reserve(size_t min_capacity) override {
+            resize(min_capacity);
+            return min_capacity <= capacity_;
+        }
+
         void resize(size_t min_capacity) {
             if (min_capacity <= capacity_) return;
             size_t new_cap;
@@ -489,21 +1642,15 @@ class DynamicString : public string {
             char* new_buf = new char[new_cap + 1];
             if (!new_buf) return;
 
-            if (m_len > 0) memcpy(new_buf, buffer, m_len);
+            if (m_len > 0) memcpy(new_buf, buf(), m_len);
             new_buf[m_len] = '\0';
 
-            delete[] buffer;
-            buffer = new_buf;
+            delete[] buf();
+            m_data = new_buf;
             capacity_ = new_cap;
-            sync_view();
         }
 
-        bool concat(const char* str) override {
-            if (str == nullptr) return false;
-            size_t str_len = strlen(str);
-            if (m_len + str_len > capacity_) resize(m_len + str_len);
-            return string::concat(str);
-        }
+        using string::concat;
 
         bool concat(char c) override {
             if (m_len + 1 > capacity_) resize(m_len + 1);
@@ -515,12 +1662,14 @@ class DynamicString : public string {
             return string::concat(sv);
         }
 
-        bool replace(const char* old_str, const char* new_str) override {
+        using string::replace;
+
+        bool replace(const string_view& old_str, const string_view& new_str) override {
             int index = find(old_str);
             if (index == -1) return false;
 
-            size_t old_len = strlen(old_str);
-            size_t new_len = strlen(new_str);
+            size_t old_len = old_str.size();
+            size_t new_len = new_str.size();
             
             size_t projected_len;
             if (new_len >= old_len) projected_len = m_len + (new_len - old_len);
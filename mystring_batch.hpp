@@ -0,0 +1,233 @@
+#pragma once
+#include "mystring.hpp"
+
+#ifndef ARDUINO
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Host-side data-parallel helpers for large arrays of string_views (log
+// lines, mapped records). The views are only read, except by batchSort.
+
+// Persistent worker threads for flat parallel loops. Work is handed out in
+// grain-sized chunks from a shared atomic cursor, so threads that finish
+// early keep pulling chunks and uneven lines balance out without per-thread
+// queues. The calling thread works too. Calls are serialised; fn must not
+// call back into the same pool.
+class BatchPool {
+    typedef std::function<void(size_t, size_t)> chunk_fn;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_call;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const chunk_fn* m_job;
+    size_t m_total;
+    size_t m_grain;
+    std::atomic<size_t> m_next;
+    size_t m_active;
+    unsigned long m_generation;
+    bool m_stop;
+
+    void runChunks(const chunk_fn& fn, size_t total, size_t grain) {
+        for (;;) {
+            size_t begin = m_next.fetch_add(grain, std::memory_order_relaxed);
+            if (begin >= total) break;
+            fn(begin, (total - begin < grain) ? total : begin + grain);
+        }
+    }
+
+    void workerLoop() {
+        unsigned long seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            const chunk_fn* job = m_job;
+            size_t total = m_total, grain = m_grain;
+            lock.unlock();
+            runChunks(*job, total, grain);
+            lock.lock();
+            if (--m_active == 0) m_done.notify_one();
+        }
+    }
+
+public:
+    // threads counts the caller; 0 uses every hardware thread.
+    explicit BatchPool(unsigned threads = 0)
+        : m_job(nullptr), m_total(0), m_grain(1), m_next(0), m_active(0), m_generation(0), m_stop(false) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        for (unsigned i = 1; i < threads; ++i) {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~BatchPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (size_t i = 0; i < m_workers.size(); ++i) m_workers[i].join();
+    }
+
+    BatchPool(const BatchPool&) = delete;
+    BatchPool& operator=(const BatchPool&) = delete;
+
+    unsigned threads() const { return static_cast<unsigned>(m_workers.size() + 1); }
+
+    // Calls fn(begin, end) over [0, total) in chunks of grain items.
+    void parallelFor(size_t total, size_t grain, const chunk_fn& fn) {
+        if (grain == 0) grain = 1;
+        if (m_workers.empty() || total <= grain) {
+            if (total > 0) fn(0, total);
+            return;
+        }
+        std::lock_guard<std::mutex> call(m_call);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &fn;
+            m_total = total;
+            m_grain = grain;
+            m_next.store(0, std::memory_order_relaxed);
+            m_active = m_workers.size();
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        runChunks(fn, total, grain);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&] { return m_active == 0; });
+    }
+};
+
+// One bit per input item. Chunks handed to threads are multiples of 64
+// items, so no two threads ever write the same word.
+class BatchBitmap {
+    std::vector<uint64_t> m_words;
+    size_t m_size;
+
+public:
+    BatchBitmap() : m_size(0) {}
+
+    void resize(size_t bits) {
+        m_words.assign((bits + 63) / 64, 0);
+        m_size = bits;
+    }
+
+    size_t size() const { return m_size; }
+    bool test(size_t i) const { return (m_words[i / 64] >> (i % 64)) & 1; }
+    void set(size_t i) { m_words[i / 64] |= uint64_t(1) << (i % 64); }
+    uint64_t* words() { return m_words.data(); }
+
+    size_t count() const {
+        size_t n = 0;
+        for (size_t i = 0; i < m_words.size(); ++i) n += __builtin_popcountll(m_words[i]);
+        return n;
+    }
+
+    // Positions of the set bits, ascending.
+    void toIndices(std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t w = 0; w < m_words.size(); ++w) {
+            uint64_t bits = m_words[w];
+            while (bits) {
+                out.push_back(static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+};
+
+static const size_t BATCH_GRAIN = 4096;  // items per chunk, a multiple of 64
+
+// positions[i] = items[i].find(needle), or -1.
+inline void batchFind(BatchPool& pool, const string_view* items, size_t count,
+                      const string_view& needle, int* positions) {
+    pool.parallelFor(count, BATCH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) positions[i] = items[i].find(needle);
+    });
+}
+
+// Sets bit i of out for every item where pred(items[i]) holds.
+template <typename Pred>
+void batchFilter(BatchPool& pool, const string_view* items, size_t count, Pred pred, BatchBitmap& out) {
+    out.resize(count);
+    uint64_t* words = out.words();
+    pool.parallelFor(count, BATCH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t w = begin; w < end; w += 64) {
+            size_t stop = (end - w < 64) ? end : w + 64;
+            uint64_t bits = 0;
+            for (size_t i = w; i < stop; ++i) {
+                if (pred(items[i])) bits |= uint64_t(1) << (i - w);
+            }
+            words[w / 64] = bits;
+        }
+    });
+}
+
+template <typename Pred>
+size_t batchCount(BatchPool& pool, const string_view* items, size_t count, Pred pred) {
+    std::atomic<size_t> total(0);
+    pool.parallelFor(count, BATCH_GRAIN, [&](size_t begin, size_t end) {
+        size_t n = 0;
+        for (size_t i = begin; i < end; ++i) n += pred(items[i]) ? 1 : 0;
+        total.fetch_add(n, std::memory_order_relaxed);
+    });
+    return total.load();
+}
+
+// Ready-made predicates: batchCount(pool, lines, n, TextContains("ERROR")).
+struct TextContains {
+    string_view needle;
+    explicit TextContains(const string_view& n) : needle(n) {}
+    bool operator()(const string_view& s) const { return s.find(needle) >= 0; }
+};
+
+struct TextStartsWith {
+    string_view prefix;
+    explicit TextStartsWith(const string_view& p) : prefix(p) {}
+    bool operator()(const string_view& s) const { return s.startsWith(prefix); }
+};
+
+struct TextEquals {
+    string_view text;
+    explicit TextEquals(const string_view& t) : text(t) {}
+    bool operator()(const string_view& s) const { return s == text; }
+};
+
+// Sorts the views bytewise: each thread sorts one run, then runs are merged
+// pairwise, with the merges of a round running in parallel.
+inline void batchSort(BatchPool& pool, string_view* items, size_t count) {
+    size_t runs = pool.threads();
+    if (runs < 2 || count < 2 * BATCH_GRAIN) {
+        std::sort(items, items + count);
+        return;
+    }
+    size_t run_len = (count + runs - 1) / runs;
+    pool.parallelFor(runs, 1, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            size_t lo = r * run_len;
+            size_t hi = (lo + run_len < count) ? lo + run_len : count;
+            if (lo < hi) std::sort(items + lo, items + hi);
+        }
+    });
+    for (size_t width = run_len; width < count; width *= 2) {
+        size_t pairs = (count + 2 * width - 1) / (2 * width);
+        pool.parallelFor(pairs, 1, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                size_t lo = p * 2 * width;
+                size_t mid = (lo + width < count) ? lo + width : count;
+                size_t hi = (mid + width < count) ? mid + width : count;
+                if (mid < hi) std::inplace_merge(items + lo, items + mid, items + hi);
+            }
+        });
+    }
+}
+
+#endif
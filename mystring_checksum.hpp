@@ -0,0 +1,262 @@
+#pragma once
+#include "mystring.hpp"
+
+// Incremental checksums over string_view. Every engine has the same shape:
+// update() with as many chunks as needed, value() for the result so far
+// (update can continue afterwards), reset() to start over.
+//
+//     Crc16Modbus crc;
+//     crc.update(header);
+//     crc.update(payload);
+//     appendChecksumHex(frame, crc);
+
+// Hardware CRC32C: SSE4.2 on x86 (checked at run time, so the header needs
+// no -msse4.2) and the CRC32 extension on ARMv8 when the compiler targets it.
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define MYSTRING_CRC32C_HW_X86
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define MYSTRING_CRC32C_HW_ARM
+#endif
+
+// XOR of all bytes, as used by NMEA 0183.
+class Xor8 {
+    uint8_t m_value;
+
+public:
+    typedef uint8_t value_type;
+    Xor8() : m_value(0) {}
+    void reset() { m_value = 0; }
+    void update(const string_view& data) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+        size_t n = data.size(), i = 0;
+        utf8_word acc = 0;  // fold a word at a time, then the lanes
+        for (; i + sizeof(utf8_word) <= n; i += sizeof(utf8_word)) acc ^= utf8_load(data.data() + i);
+        uint8_t v = m_value;
+        for (size_t k = 0; k < sizeof(utf8_word); ++k) v ^= static_cast<uint8_t>(acc >> (8 * k));
+        for (; i < n; ++i) v ^= p[i];
+        m_value = v;
+    }
+    uint8_t value() const { return m_value; }
+};
+
+// Longitudinal redundancy check of Modbus ASCII: the two's complement of
+// the byte sum. Feed it the binary message (decodeHex the frame first).
+class Lrc8 {
+    uint8_t m_sum;
+
+public:
+    typedef uint8_t value_type;
+    Lrc8() : m_sum(0) {}
+    void reset() { m_sum = 0; }
+    void update(const string_view& data) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+        uint8_t sum = m_sum;
+        for (size_t i = 0; i < data.size(); ++i) sum = static_cast<uint8_t>(sum + p[i]);
+        m_sum = sum;
+    }
+    uint8_t value() const { return static_cast<uint8_t>(-m_sum); }
+};
+
+// Lookup tables for a CRC, built at compile time from C++14. Reflected
+// CRCs shift right and take the bit-reversed polynomial. Slices > 1 adds
+// the extra tables of slicing-by-N.
+template <typename T, T Poly, bool Reflected, size_t Slices>
+struct crc_table {
+    T entries[Slices][256];
+
+    MYSTRING_CONSTEXPR14 crc_table() : entries() {
+        const size_t bits = sizeof(T) * 8;
+        for (size_t b = 0; b < 256; ++b) {
+            T crc = Reflected ? static_cast<T>(b) : static_cast<T>(static_cast<T>(b) << (bits - 8));
+            for (int k = 0; k < 8; ++k) {
+                if (Reflected) crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ Poly) : static_cast<T>(crc >> 1);
+                else crc = (crc >> (bits - 1)) ? static_cast<T>((crc << 1) ^ Poly) : static_cast<T>(crc << 1);
+            }
+            entries[0][b] = crc;
+        }
+        for (size_t s = 1; s < Slices; ++s) {
+            for (size_t b = 0; b < 256; ++b) {
+                T prev = entries[s - 1][b];
+                entries[s][b] = static_cast<T>((prev >> 8) ^ entries[0][prev & 0xFF]);
+            }
+        }
+    }
+};
+
+// Slicing-by-8 needs 8 KB of tables for a 32-bit CRC: fine on a host, too
+// much for small parts, which use the single 1 KB table.
+#if defined(ARDUINO)
+static const size_t CRC32_SLICES = 1;
+#else
+static const size_t CRC32_SLICES = 8;
+#endif
+
+template <typename T, T Poly, T Init, bool Reflected, T XorOut, size_t Slices = 1>
+class Crc {
+    typedef crc_table<T, Poly, Reflected, Slices> table_type;
+
+    static const table_type& table() {
+        static MYSTRING_CONSTEXPR14 const table_type t;
+        return t;
+    }
+
+    T m_crc;
+
+public:
+    typedef T value_type;
+    Crc() : m_crc(Init) {}
+    void reset() { m_crc = Init; }
+    T value() const { return static_cast<T>(m_crc ^ XorOut); }
+
+    void update(const string_view& data) {
+        m_crc = advance(m_crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    // Raw register step, without Init or XorOut.
+    static T advance(T crc, const uint8_t* p, size_t n) {
+        const T(&t)[Slices][256] = table().entries;
+        if (Slices == 8 && Reflected && sizeof(T) == 4) {
+            // Eight bytes per step: the CRC is folded into the first word and
+            // each byte indexes the table for its distance from the end.
+            for (; n >= 8; p += 8, n -= 8) {
+                uint32_t lo = static_cast<uint32_t>(crc) ^
+                              (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24);
+                crc = static_cast<T>(t[Slices - 1][lo & 0xFF] ^ t[Slices - 2][(lo >> 8) & 0xFF] ^
+                                     t[Slices - 3][(lo >> 16) & 0xFF] ^ t[Slices - 4][lo >> 24] ^
+                                     t[Slices - 5][p[4]] ^ t[Slices - 6][p[5]] ^
+                                     t[Slices - 7][p[6]] ^ t[0][p[7]]);
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (Reflected) crc = static_cast<T>((crc >> 8) ^ t[0][(crc ^ p[i]) & 0xFF]);
+            else crc = static_cast<T>((crc << 8) ^ t[0][((crc >> (sizeof(T) * 8 - 8)) ^ p[i]) & 0xFF]);
+        }
+        return crc;
+    }
+};
+
+typedef Crc<uint16_t, 0x1021, 0xFFFF, false, 0> Crc16CcittFalse;  // check 0x29B1
+typedef Crc<uint16_t, 0xA001, 0xFFFF, true, 0> Crc16Modbus;       // check 0x4B37
+typedef Crc<uint16_t, 0x1021, 0x0000, false, 0> Crc16Xmodem;      // check 0x31C3
+typedef Crc<uint16_t, 0x8408, 0x0000, true, 0> Crc16Kermit;       // check 0x2189
+typedef Crc<uint32_t, 0xEDB88320u, 0xFFFFFFFFu, true, 0xFFFFFFFFu, CRC32_SLICES> Crc32;  // check 0xCBF43926
+
+// CRC-32C (Castagnoli, check 0xE3069283), in hardware where available.
+class Crc32c {
+    typedef Crc<uint32_t, 0x82F63B78u, 0xFFFFFFFFu, true, 0xFFFFFFFFu, CRC32_SLICES> software_type;
+
+    uint32_t m_crc;
+
+#if defined(MYSTRING_CRC32C_HW_X86)
+    __attribute__((target("sse4.2"))) static uint32_t hw_update(uint32_t crc, const char* p, size_t n) {
+#if defined(__x86_64__)
+        uint64_t c = crc;
+        for (; n >= 8; p += 8, n -= 8) {
+            uint64_t w;
+            memcpy(&w, p, 8);
+            c = _mm_crc32_u64(c, w);
+        }
+        crc = static_cast<uint32_t>(c);
+#endif
+        for (; n >= 4; p += 4, n -= 4) {
+            uint32_t w;
+            memcpy(&w, p, 4);
+            crc = _mm_crc32_u32(crc, w);
+        }
+        for (; n > 0; ++p, --n) crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*p));
+        return crc;
+    }
+#elif defined(MYSTRING_CRC32C_HW_ARM)
+    static uint32_t hw_update(uint32_t crc, const char* p, size_t n) {
+        for (; n >= 8; p += 8, n -= 8) {
+            uint64_t w;
+            memcpy(&w, p, 8);
+            crc = __crc32cd(crc, w);
+        }
+        for (; n > 0; ++p, --n) crc = __crc32cb(crc, static_cast<uint8_t>(*p));
+        return crc;
+    }
+#endif
+
+public:
+    typedef uint32_t value_type;
+    Crc32c() : m_crc(0xFFFFFFFFu) {}
+    void reset() { m_crc = 0xFFFFFFFFu; }
+    uint32_t value() const { return m_crc ^ 0xFFFFFFFFu; }
+
+    static bool hardware() {
+#if defined(MYSTRING_CRC32C_HW_X86)
+        static const bool supported = __builtin_cpu_supports("sse4.2");
+        return supported;
+#elif defined(MYSTRING_CRC32C_HW_ARM)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void update(const string_view& data) {
+#if defined(MYSTRING_CRC32C_HW_X86) || defined(MYSTRING_CRC32C_HW_ARM)
+        if (hardware()) {
+            m_crc = hw_update(m_crc, data.data(), data.size());
+            return;
+        }
+#endif
+        updateSoftware(data);
+    }
+
+    // Table-driven path, also used to cross-check the hardware one.
+    void updateSoftware(const string_view& data) {
+        m_crc = software_type::advance(m_crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+};
+
+// Appends the checksum as fixed-width hex (two digits per byte, most
+// significant first). Returns false if out truncated it.
+template <typename Engine>
+bool appendChecksumHex(string& out, const Engine& engine, bool uppercase = true) {
+    typename Engine::value_type v = engine.value();
+    uint8_t bytes[sizeof(v)];
+    for (size_t i = 0; i < sizeof(v); ++i) bytes[i] = static_cast<uint8_t>(v >> (8 * (sizeof(v) - 1 - i)));
+    return out.appendHex(bytes, sizeof(v), uppercase);
+}
+
+// True if frame ends in the hex checksum (either case) of everything
+// before it. Nothing is copied.
+template <typename Engine>
+bool verifyTrailingHex(const string_view& frame) {
+    const size_t digits = 2 * sizeof(typename Engine::value_type);
+    if (frame.size() < digits) return false;
+    size_t body = frame.size() - digits;
+    uint64_t expected = 0;
+    for (size_t i = 0; i < digits; ++i) {
+        int d = hex_value(frame[body + i]);
+        if (d < 0) return false;
+        expected = (expected << 4) | static_cast<uint64_t>(d);
+    }
+    Engine engine;
+    engine.update(frame.substr(0, body));
+    return engine.value() == expected;
+}
+
+// NMEA 0183: "$GPGGA,...*47", optionally followed by "\r\n". The XOR
+// covers the bytes between '$' (or '!') and '*'.
+inline bool nmeaChecksumValid(const string_view& sentence) {
+    string_view s = sentence;
+    while (s.size() > 0 && (s[s.size() - 1] == '\n' || s[s.size() - 1] == '\r')) s = s.removeSuffix(1);
+    if (s.size() < 4 || (s[0] != '$' && s[0] != '!') || s[s.size() - 3] != '*') return false;
+    Xor8 x;
+    x.update(s.slice(1, s.size() - 3));
+    int hi = hex_value(s[s.size() - 2]), lo = hex_value(s[s.size() - 1]);
+    return hi >= 0 && lo >= 0 && x.value() == ((hi << 4) | lo);
+}
+
+// Appends "*HH" to a sentence that starts with '$' and has no checksum yet.
+inline bool appendNmeaChecksum(string& sentence) {
+    Xor8 x;
+    x.update(string_view(sentence).removePrefix(1));
+    sentence.concat('*');
+    return appendChecksumHex(sentence, x);
+}
@@ -0,0 +1,218 @@
+#pragma once
+#include "mystring.hpp"
+
+// SMAZ-style compression of short strings against a static codebook of
+// common fragments. Each output byte is either a codebook index, or an
+// escape followed by literal bytes:
+//
+//     0..253          codebook entry
+//     254 b           one literal byte
+//     255 n b...      n + 1 literal bytes (1..256)
+//
+// The codebook is a plain array of fragments, produced offline from a
+// corpus by tools/make_codebook.cpp. From C++14 the lookup index is built
+// at compile time, so codebook and index both stay in flash:
+//
+//     static constexpr const char* UI_FRAGMENTS[] = { ... };  // generated
+//     static constexpr auto book = makeCodebook(UI_FRAGMENTS);
+//     FixedString<64> packed;
+//     smallCompress(book, "Battery low, please connect charger", packed);
+
+static const uint8_t SMALL_LITERAL = 254;
+static const uint8_t SMALL_LITERAL_RUN = 255;
+static const size_t SMALL_MAX_ENTRIES = 254;
+static const size_t SMALL_MAX_ENTRY_LEN = 255;
+
+template <size_t N>
+class SmallCodebook {
+    static_assert(N > 0 && N <= SMALL_MAX_ENTRIES, "a codebook holds at most 254 entries");
+
+    const char* const* m_entries;
+    uint8_t m_len[N];
+    uint8_t m_order[N];      // entry ids grouped by first byte
+    uint16_t m_start[257];   // m_order range for each first byte
+    bool m_overflowed;
+
+public:
+    MYSTRING_CONSTEXPR14 SmallCodebook(const char* const (&entries)[N])
+        : m_entries(entries), m_len(), m_order(), m_start(), m_overflowed(false) {
+        for (size_t i = 0; i < N; ++i) {
+            size_t len = 0;
+            while (entries[i][len]) ++len;
+            if (len == 0 || len > SMALL_MAX_ENTRY_LEN) m_overflowed = true;
+            m_len[i] = static_cast<uint8_t>(len);
+            if (len > 0) ++m_start[static_cast<uint8_t>(entries[i][0]) + 1];
+        }
+        for (size_t c = 0; c < 256; ++c) m_start[c + 1] += m_start[c];
+        uint16_t fill[256] = {};
+        for (size_t i = 0; i < N; ++i) {
+            if (m_len[i] == 0) continue;
+            uint8_t c = static_cast<uint8_t>(entries[i][0]);
+            m_order[m_start[c] + fill[c]++] = static_cast<uint8_t>(i);
+        }
+    }
+
+    // True if an entry is empty or longer than 255 bytes.
+    constexpr bool overflowed() const { return m_overflowed; }
+    constexpr size_t size() const { return N; }
+    string_view entry(uint8_t id) const { return string_view(m_entries[id], m_len[id]); }
+
+    // Longest entry that prefixes text; returns its id, or -1.
+    int longestMatch(const char* text, size_t len, size_t* match_len) const {
+        uint8_t c = static_cast<uint8_t>(text[0]);
+        int best = -1;
+        size_t best_len = 0;
+        for (uint16_t k = m_start[c]; k < m_start[c + 1]; ++k) {
+            uint8_t id = m_order[k];
+            size_t n = m_len[id];
+            if (n > best_len && n <= len && memcmp(m_entries[id], text, n) == 0) {
+                best = id;
+                best_len = n;
+            }
+        }
+        *match_len = best_len;
+        return best;
+    }
+};
+
+template <size_t N>
+MYSTRING_CONSTEXPR14 SmallCodebook<N> makeCodebook(const char* const (&entries)[N]) {
+    return SmallCodebook<N>(entries);
+}
+
+// Appends the compressed form of text to out. The longest codebook entry
+// at each position is taken greedily, and the remaining literal bytes are
+// batched into runs. Returns false if out truncated it; the partial output
+// is then not decodable.
+template <size_t N>
+bool smallCompress(const SmallCodebook<N>& book, const string_view& text, string& out) {
+    const char* p = text.data();
+    size_t n = text.size();
+    size_t i = 0, literal_start = 0;
+    size_t before = out.size(), expected = 0;
+
+    char head[2];
+    while (i <= n) {
+        size_t match_len = 0;
+        int id = (i < n) ? book.longestMatch(p + i, n - i, &match_len) : -1;
+        bool flush = (i == n) || id >= 0 || i - literal_start == 256;
+        if (flush && i > literal_start) {
+            size_t run = i - literal_start;
+            if (run == 1) {
+                head[0] = static_cast<char>(SMALL_LITERAL);
+                out.concat(string_view(head, 1));
+            } else {
+                head[0] = static_cast<char>(SMALL_LITERAL_RUN);
+                head[1] = static_cast<char>(run - 1);
+                out.concat(string_view(head, 2));
+            }
+            out.concat(string_view(p + literal_start, run));
+            expected += (run == 1 ? 1 : 2) + run;
+            literal_start = i;
+        }
+        if (i == n) break;
+        if (id >= 0) {
+            out.concat(static_cast<char>(id));
+            ++expected;
+            i += match_len;
+            literal_start = i;
+        } else {
+            ++i;
+        }
+    }
+    return out.size() == before + expected;
+}
+
+// Size of the decompressed text, or (size_t)-1 if data is malformed.
+template <size_t N>
+size_t smallDecompressedSize(const SmallCodebook<N>& book, const string_view& data) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    size_t n = data.size(), i = 0, total = 0;
+    while (i < n) {
+        uint8_t b = p[i];
+        if (b == SMALL_LITERAL) {
+            if (i + 2 > n) return (size_t)-1;
+            total += 1;
+            i += 2;
+        } else if (b == SMALL_LITERAL_RUN) {
+            if (i + 2 > n || i + 3 + p[i + 1] > n) return (size_t)-1;
+            total += p[i + 1] + 1u;
+            i += 3 + p[i + 1];
+        } else {
+            if (b >= N) return (size_t)-1;
+            total += book.entry(b).size();
+            ++i;
+        }
+    }
+    return total;
+}
+
+// Appends the decompressed text to out. The size is computed first, so
+// the output is reserved once (DynamicString grows once) and written in
+// place. Returns false, leaving out unchanged, if data is malformed or the
+// text does not fit.
+template <size_t N>
+bool smallDecompress(const SmallCodebook<N>& book, const string_view& data, string& out) {
+    size_t total = smallDecompressedSize(book, data);
+    if (total == (size_t)-1 || out.prepare_append(total) < total) return false;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    char* dst = out.data() + out.size();
+    size_t n = data.size(), i = 0;
+    while (i < n) {
+        uint8_t b = p[i];
+        if (b == SMALL_LITERAL) {
+            *dst++ = static_cast<char>(p[i + 1]);
+            i += 2;
+        } else if (b == SMALL_LITERAL_RUN) {
+            size_t run = p[i + 1] + 1u;
+            memcpy(dst, p + i + 2, run);
+            dst += run;
+            i += 2 + run;
+        } else {
+            string_view e = book.entry(b);
+            memcpy(dst, e.data(), e.size());
+            dst += e.size();
+            ++i;
+        }
+    }
+    out.commit_append(total);
+    return true;
+}
+
+// Hand-picked general-purpose fragments for English UI text and log
+// lines. Projects with their own string tables get better ratios from a
+// codebook generated from them with tools/make_codebook.cpp.
+static constexpr const char* SMALL_DEFAULT_FRAGMENTS[] = {
+    " ", "e", "t", "a", "o", "i", "n", "s", "r", "l", "d", "c", "u", "m", "p",
+    ": ", ", ", ". ", "\n", "=", "0", "1", "2", "%", "/", "-", "_", "(", ")",
+    "the ", "The ", "ing ", "ing", "ion", "tion", "ed ", "er ", "er", "re", "in",
+    "on", "an", "en", "es", "at", "or", "te", "ti", "al", "ar", "st", "nt", "is",
+    "ou", "it", "ro", "le", "de", "se", "co", "ent", "ate", "and ", "for ", "to ",
+    "of ", "is ", "not ", "no ", "ERROR", "Error", "error", "WARN", "Warning",
+    "warning", "INFO", "DEBUG", "fail", "failed", "Failed", "ready", "Ready",
+    "connect", "Connect", "connected", "disconnected", "timeout", "Timeout",
+    "sensor", "Sensor", "temp", "Temperature", "battery", "Battery", "low",
+    "power", "Power", "level", "value", "invalid", "Invalid", "start", "Start",
+    "stop", "Stop", "press", "Press", "button", "set", "Set", "update", "Update",
+    "config", "network", "Network", "WiFi", "wifi", "status", "Status", "mode",
+    "Mode", "menu", "Menu", "OK", "ok", "please ", "Please ", "retry", "Retry",
+    "reading", "write", "read", "file", "time", "date", "http", "://", "www.",
+    ".com", "ms", "%d", "%s", "  ", "    ",
+};
+
+typedef SmallCodebook<sizeof(SMALL_DEFAULT_FRAGMENTS) / sizeof(SMALL_DEFAULT_FRAGMENTS[0])> SmallDefaultCodebook;
+
+// The codebook for SMALL_DEFAULT_FRAGMENTS. It is a function-local static
+// so that translation units which never compress pay nothing for it:
+// before C++14 it is built in RAM on first use rather than by a static
+// constructor in every file that includes this header.
+static inline const SmallDefaultCodebook& defaultCodebook() {
+#if __cplusplus >= 201402L
+    static constexpr SmallDefaultCodebook book = makeCodebook(SMALL_DEFAULT_FRAGMENTS);
+    static_assert(!book.overflowed(), "default codebook entries must be 1..255 bytes");
+#else
+    static const SmallDefaultCodebook book(SMALL_DEFAULT_FRAGMENTS);
+#endif
+    return book;
+}
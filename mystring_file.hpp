@@ -0,0 +1,155 @@
+#pragma once
+#include "mystring.hpp"
+
+#ifndef ARDUINO
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Splits a view into lines without copying. Each line excludes its '\n'
+// (and a preceding '\r'); a trailing line without '\n' is still yielded.
+class line_iterator {
+    const char* m_pos;
+    const char* m_end;
+    string_view m_line;
+    const char* m_next;
+
+    void scan() {
+        if (m_pos == m_end) {
+            m_next = m_end;
+            m_line = string_view();
+            return;
+        }
+        const char* nl = static_cast<const char*>(memchr(m_pos, '\n', m_end - m_pos));
+        const char* stop = nl ? nl : m_end;
+        m_next = nl ? nl + 1 : m_end;
+        if (stop > m_pos && stop[-1] == '\r') --stop;
+        m_line = string_view(m_pos, stop - m_pos);
+    }
+
+public:
+    line_iterator(const char* pos, const char* end) : m_pos(pos), m_end(end), m_next(pos) { scan(); }
+
+    const string_view& operator*() const { return m_line; }
+    const string_view* operator->() const { return &m_line; }
+
+    line_iterator& operator++() {
+        m_pos = m_next;
+        scan();
+        return *this;
+    }
+
+    bool operator==(const line_iterator& other) const { return m_pos == other.m_pos; }
+    bool operator!=(const line_iterator& other) const { return m_pos != other.m_pos; }
+};
+
+struct line_range {
+    const char* first;
+    const char* last;
+    line_iterator begin() const { return line_iterator(first, last); }
+    line_iterator end() const { return line_iterator(last, last); }
+};
+
+inline line_range lines(const string_view& text) {
+    line_range r = { text.data(), text.data() + text.size() };
+    return r;
+}
+
+// Read-only view of a whole file. Regular files are mmapped, so view() and
+// the line views point straight into the page cache. Pipes, terminals and
+// anything else mmap refuses are read in 64 KB blocks into a DynamicString
+// that doubles as it fills.
+class MappedFile {
+    int m_fd;
+    const char* m_map;
+    size_t m_size;
+    DynamicString m_fallback;
+
+    bool readAll(int fd) {
+        const size_t BLOCK = 64 * 1024;
+        m_fallback.clear();
+        for (;;) {
+            if (m_fallback.capacity() - m_fallback.size() < BLOCK) {
+                size_t want = m_fallback.capacity() * 2;
+                if (want < m_fallback.size() + BLOCK) want = m_fallback.size() + BLOCK;
+                if (!m_fallback.reserve(want)) return false;
+            }
+            ssize_t n = ::read(fd, m_fallback.data() + m_fallback.size(),
+                               m_fallback.capacity() - m_fallback.size());
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (n == 0) break;
+            m_fallback.commit_append(static_cast<size_t>(n));
+        }
+        m_size = m_fallback.size();
+        return true;
+    }
+
+public:
+    MappedFile() : m_fd(-1), m_map(nullptr), m_size(0), m_fallback(8) {}
+    explicit MappedFile(const char* path) : MappedFile() { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        return openFd(fd);
+    }
+
+    // Takes ownership of fd (e.g. STDIN_FILENO for "tool < file" or a pipe)
+    // whether or not it succeeds: on failure fd is closed before returning.
+    bool openFd(int fd) {
+        close();
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, size, MADV_SEQUENTIAL);
+                m_map = static_cast<const char*>(p);
+                m_size = size;
+                m_fd = fd;
+                return true;
+            }
+        }
+        // Regular files reporting size 0 may still have contents (/proc,
+        // /sys), so they are read like pipes.
+        if (!readAll(fd)) {
+            m_fallback.clear();
+            m_size = 0;
+            ::close(fd);
+            return false;
+        }
+        m_fd = fd;
+        return true;
+    }
+
+    void close() {
+        if (m_map) munmap(const_cast<char*>(m_map), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = -1;
+        m_map = nullptr;
+        m_size = 0;
+        m_fallback.clear();
+    }
+
+    bool isOpen() const { return m_fd >= 0; }
+    bool isMapped() const { return m_map != nullptr; }
+    size_t size() const { return m_size; }
+
+    string_view view() const {
+        if (m_map) return string_view(m_map, m_size);
+        return string_view(m_fallback.c_str(), m_fallback.size());
+    }
+
+    line_range lines() const { return ::lines(view()); }
+};
+#endif
@@ -0,0 +1,200 @@
+#pragma once
+#include "mystring.hpp"
+
+// Bounded Levenshtein distance and approximate search with Myers'
+// bit-parallel algorithm (Hyyro's block form): each pattern column is one
+// bit, so a text character costs one pass over ceil(m / word bits) words
+// instead of m cells. Words are 64-bit on 64-bit hosts, 32-bit elsewhere.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t fuzzy_word;
+#else
+typedef uint32_t fuzzy_word;
+#endif
+
+static const size_t FUZZY_WORD_BITS = sizeof(fuzzy_word) * 8;
+
+// Compiled pattern: a bitmask of matching positions per distinct pattern
+// character. Build it once and compare it against many candidates.
+template <size_t MaxLen = 64>
+class FuzzyPattern {
+    static const size_t BLOCKS = (MaxLen + FUZZY_WORD_BITS - 1) / FUZZY_WORD_BITS;
+
+    uint8_t m_slot[256];  // 0: not in the pattern, else 1 + index into m_masks
+    fuzzy_word m_masks[MaxLen][BLOCKS];
+    size_t m_len;
+    size_t m_blocks;
+    bool m_valid;
+
+    // One column step for one block; returns the horizontal delta leaving
+    // its last row. hin is the delta entering the top row (-1, 0 or +1).
+    static int advance(fuzzy_word& pv, fuzzy_word& mv, fuzzy_word eq, int hin, fuzzy_word out_bit) {
+        fuzzy_word hin_neg = (hin < 0) ? 1 : 0;
+        fuzzy_word xv = eq | mv;
+        eq |= hin_neg;
+        fuzzy_word xh = (((eq & pv) + pv) ^ pv) | eq;
+        fuzzy_word ph = mv | ~(xh | pv);
+        fuzzy_word mh = pv & xh;
+        int hout = ((ph & out_bit) ? 1 : 0) - ((mh & out_bit) ? 1 : 0);
+        ph = (ph << 1) | ((hin > 0) ? 1 : 0);
+        mh = (mh << 1) | hin_neg;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        return hout;
+    }
+
+public:
+    // reversed compiles the pattern back to front, for scanning text
+    // backwards. Patterns longer than MaxLen leave the object invalid.
+    FuzzyPattern(const string_view& pattern, bool reversed = false)
+        : m_len(pattern.size()), m_blocks((pattern.size() + FUZZY_WORD_BITS - 1) / FUZZY_WORD_BITS),
+          m_valid(pattern.size() <= MaxLen) {
+        memset(m_slot, 0, sizeof(m_slot));
+        if (!m_valid) {
+            PRINT_WARNING("WARNING: Fuzzy pattern too long.");
+            return;
+        }
+        size_t distinct = 0;
+        for (size_t i = 0; i < m_len; ++i) {
+            uint8_t c = static_cast<uint8_t>(pattern[reversed ? m_len - 1 - i : i]);
+            if (m_slot[c] == 0) {
+                m_slot[c] = static_cast<uint8_t>(++distinct);
+                memset(m_masks[distinct - 1], 0, sizeof(m_masks[0]));
+            }
+            m_masks[m_slot[c] - 1][i / FUZZY_WORD_BITS] |= fuzzy_word(1) << (i % FUZZY_WORD_BITS);
+        }
+    }
+
+    bool valid() const { return m_valid; }
+    size_t size() const { return m_len; }
+
+    // Feeds text (backwards if reverse) through the automaton and calls
+    // on_column(j, score) after each character, where score is the cost of
+    // the whole pattern against the text consumed so far: the edit distance
+    // to text[0..j) when anchored, or the best match ending at j when not.
+    // Scanning stops when on_column returns false.
+    template <typename F>
+    void scan(const string_view& text, bool anchored, bool reverse, F on_column) const {
+        fuzzy_word pv[BLOCKS], mv[BLOCKS];
+        for (size_t b = 0; b < m_blocks; ++b) {
+            pv[b] = ~fuzzy_word(0);
+            mv[b] = 0;
+        }
+        static const fuzzy_word ZERO[BLOCKS] = {};
+        fuzzy_word top_bit = fuzzy_word(1) << (FUZZY_WORD_BITS - 1);
+        fuzzy_word last_bit = fuzzy_word(1) << ((m_len - 1) % FUZZY_WORD_BITS);
+
+        size_t score = m_len;
+        size_t n = text.size();
+        for (size_t j = 0; j < n; ++j) {
+            uint8_t c = static_cast<uint8_t>(text[reverse ? n - 1 - j : j]);
+            const fuzzy_word* eq = m_slot[c] ? m_masks[m_slot[c] - 1] : ZERO;
+            int h = anchored ? 1 : 0;
+            for (size_t b = 0; b < m_blocks; ++b) {
+                h = advance(pv[b], mv[b], eq[b], h, (b + 1 == m_blocks) ? last_bit : top_bit);
+            }
+            score += h;
+            if (!on_column(j + 1, score)) return;
+        }
+    }
+
+    // Edit distance to text, or -1 as soon as it is certain to exceed
+    // max_dist: each remaining character can lower the score by at most 1.
+    int distance(const string_view& text, size_t max_dist) const {
+        if (!m_valid) return -1;
+        size_t n = text.size();
+        size_t gap = (n > m_len) ? n - m_len : m_len - n;
+        if (gap > max_dist) return -1;
+        if (m_len == 0) return static_cast<int>(n);
+
+        size_t result = m_len;  // distance before any text is consumed
+        bool exceeded = false;
+        scan(text, true, false, [&](size_t j, size_t score) {
+            if (score > max_dist + (n - j)) {
+                exceeded = true;
+                return false;
+            }
+            result = score;
+            return true;
+        });
+        return (exceeded || result > max_dist) ? -1 : static_cast<int>(result);
+    }
+};
+
+// Defined here rather than in mystring.hpp so that only users of fuzzy
+// matching pay for the pattern tables.
+inline int string_view::editDistance(const string_view& other, size_t max_dist) const {
+    // The shorter string becomes the bit-parallel pattern.
+    const string_view& pattern = (m_len <= other.m_len) ? *this : other;
+    const string_view& text = (m_len <= other.m_len) ? other : *this;
+    return FuzzyPattern<>(pattern).distance(text, max_dist);
+}
+
+inline int string_view::fuzzyFind(const string_view& pattern, size_t max_dist, size_t* match_len) const {
+    FuzzyPattern<> forward(pattern);
+    if (!forward.valid()) return -1;
+    if (pattern.size() == 0) {
+        if (match_len) *match_len = 0;
+        return 0;
+    }
+
+    // Leftmost end position with the lowest cost...
+    // The empty match at 0 costs the pattern length.
+    size_t best = (pattern.size() <= max_dist) ? pattern.size() : max_dist + 1, end = 0;
+    forward.scan(*this, false, false, [&](size_t j, size_t score) {
+        if (score < best) {
+            best = score;
+            end = j;
+        }
+        return best > 0;
+    });
+    if (best > max_dist) return -1;
+
+    // ...then the nearest start that achieves it, scanning back from there.
+    // When best equals the pattern length, the empty match is as good as any.
+    FuzzyPattern<> backward(pattern, true);
+    size_t span = 0;
+    if (best < pattern.size()) backward.scan(string_view(m_data, end), true, true, [&](size_t j, size_t score) {
+        if (score == best) {
+            span = j;
+            return false;
+        }
+        return true;
+    });
+    if (match_len) *match_len = span;
+    return static_cast<int>(end - span);
+}
+
+struct FuzzyMatch {
+    uint16_t index;     // position in the candidate table
+    uint16_t distance;
+};
+
+// Fills out with up to k candidates within max_dist of input, closest
+// first (ties keep table order), and returns how many were found. Once k
+// matches are held, the bound tightens to beat the worst of them, so most
+// candidates are rejected after a few characters.
+template <typename T>
+size_t fuzzySuggest(const string_view& input, const T* table, size_t count, size_t max_dist,
+                    FuzzyMatch* out, size_t k) {
+    FuzzyPattern<> pattern(input);
+    if (!pattern.valid() || k == 0) return 0;
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t bound = max_dist;
+        if (found == k) {
+            if (out[k - 1].distance == 0) break;
+            bound = out[k - 1].distance - 1u;
+        }
+        int d = pattern.distance(string_view(table[i]), bound);
+        if (d < 0) continue;
+
+        size_t pos = (found < k) ? found++ : k - 1;
+        while (pos > 0 && out[pos - 1].distance > static_cast<uint16_t>(d)) {
+            out[pos] = out[pos - 1];
+            --pos;
+        }
+        out[pos].index = static_cast<uint16_t>(i);
+        out[pos].distance = static_cast<uint16_t>(d);
+    }
+    return found;
+}
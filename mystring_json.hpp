@@ -0,0 +1,260 @@
+#pragma once
+#include "mystring.hpp"
+#include <limits.h>
+#include <stdlib.h>
+
+// Non-allocating JSON tokenizer. Tokens are views into the input buffer,
+// so the payload must outlive them. Strings keep their raw (escaped) text
+// and are only decoded when unescape() is called.
+//
+//     JsonTokenizer json(payload);
+//     JsonToken temp;
+//     if (json.get("sensor.temp", temp)) temp.toDouble(value);
+
+enum JsonTokenType {
+    JSON_OBJECT_START,
+    JSON_OBJECT_END,
+    JSON_ARRAY_START,
+    JSON_ARRAY_END,
+    JSON_KEY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_END,
+    JSON_ERROR
+};
+
+struct JsonToken {
+    JsonTokenType type = JSON_END;
+    // Strings and keys: the contents between the quotes, still escaped.
+    // Numbers and literals: their text. Containers returned by get(): the
+    // whole container including brackets. Structural tokens: the bracket.
+    string_view text;
+    bool escaped = false;
+
+    bool isString() const { return type == JSON_STRING || type == JSON_KEY; }
+
+    // Decode the string into `out` (appending). Returns false, leaving out
+    // unchanged, on a malformed escape or if the result does not fit.
+    bool unescape(string& out) const {
+        return isString() && out.appendJsonUnescaped(text);
+    }
+
+    bool toInt(long& value) const {
+        if (type != JSON_NUMBER || text.size() == 0) return false;
+        const char* p = text.data();
+        const char* end = p + text.size();
+        bool neg = *p == '-';
+        if (neg) ++p;
+        if (p == end) return false;
+        // LONG_MIN's magnitude is one more than LONG_MAX.
+        unsigned long limit = static_cast<unsigned long>(LONG_MAX) + (neg ? 1 : 0);
+        unsigned long v = 0;
+        for (; p < end; ++p) {
+            if (*p < '0' || *p > '9') return false;  // fractions and exponents
+            unsigned long d = static_cast<unsigned long>(*p - '0');
+            if (v > (limit - d) / 10) return false;  // out of range for long
+            v = v * 10 + d;
+        }
+        value = (neg && v > 0) ? -static_cast<long>(v - 1) - 1 : static_cast<long>(v);
+        return true;
+    }
+
+    bool toDouble(double& value) const {
+        if (type != JSON_NUMBER) return false;
+        FixedString<32> tmp;  // strtod needs a terminator the view lacks
+        if (text.size() > tmp.capacity()) return false;
+        tmp.assign(text.data(), text.size());
+        char* stop;
+        value = strtod(tmp.c_str(), &stop);
+        return stop == tmp.c_str() + tmp.size();
+    }
+};
+
+class JsonTokenizer {
+    static const size_t MAX_DEPTH = 32;
+
+    string_view m_input;
+    size_t m_pos;
+    uint32_t m_objects;  // bit i set: container at depth i+1 is an object
+    size_t m_depth;
+    bool m_want_key;
+
+    bool fail(JsonToken& tok) {
+        tok.type = JSON_ERROR;
+        tok.text = string_view(m_input.data() + m_pos, 0);
+        m_pos = m_input.size();
+        return false;
+    }
+
+    bool open(JsonToken& tok, JsonTokenType type, bool object) {
+        if (m_depth == MAX_DEPTH) return fail(tok);
+        if (object) m_objects |= (1UL << m_depth);
+        else m_objects &= ~(1UL << m_depth);
+        ++m_depth;
+        m_want_key = object;
+        tok.type = type;
+        tok.text = string_view(m_input.data() + m_pos++, 1);
+        return true;
+    }
+
+    bool close(JsonToken& tok, JsonTokenType type, bool object) {
+        if (m_depth == 0 || inObject() != object) return fail(tok);
+        --m_depth;
+        m_want_key = false;
+        tok.type = type;
+        tok.text = string_view(m_input.data() + m_pos++, 1);
+        return true;
+    }
+
+    bool inObject() const { return m_depth > 0 && (m_objects & (1UL << (m_depth - 1))); }
+
+    bool keyEquals(const JsonToken& key, const string_view& name) const {
+        if (!key.escaped) return key.text == name;
+        FixedString<64> decoded;
+        return key.unescape(decoded) && decoded == name;
+    }
+
+    // Consume the rest of a value whose first token is `tok`, leaving
+    // `last` on its final token.
+    bool skipValue(const JsonToken& tok, JsonToken& last) {
+        last = tok;
+        if (tok.type != JSON_OBJECT_START && tok.type != JSON_ARRAY_START) return tok.type != JSON_ERROR;
+        size_t target = m_depth - 1;
+        while (m_depth > target) {
+            if (!next(last)) return false;
+        }
+        return true;
+    }
+
+public:
+    JsonTokenizer(const string_view& input) : m_input(input) { reset(); }
+
+    void reset() {
+        m_pos = 0;
+        m_objects = 0;
+        m_depth = 0;
+        m_want_key = false;
+    }
+
+    size_t depth() const { return m_depth; }
+
+    // Produce the next token. Returns false at the end of input (JSON_END)
+    // or on malformed input (JSON_ERROR). Commas and colons are consumed
+    // as separators rather than returned.
+    bool next(JsonToken& tok) {
+        tok.escaped = false;
+        const char* s = m_input.data();
+        size_t n = m_input.size();
+        for (;;) {
+            while (m_pos < n && (s[m_pos] == ' ' || s[m_pos] == '\t' || s[m_pos] == '\n' || s[m_pos] == '\r')) ++m_pos;
+            if (m_pos == n) {
+                tok.type = m_depth == 0 ? JSON_END : JSON_ERROR;
+                tok.text = string_view(s + n, 0);
+                return false;
+            }
+            char c = s[m_pos];
+            if (c == ',') { m_want_key = inObject(); ++m_pos; continue; }
+            if (c == ':') { m_want_key = false; ++m_pos; continue; }
+            break;
+        }
+
+        char c = s[m_pos];
+        switch (c) {
+            case '{': return open(tok, JSON_OBJECT_START, true);
+            case '[': return open(tok, JSON_ARRAY_START, false);
+            case '}': return close(tok, JSON_OBJECT_END, true);
+            case ']': return close(tok, JSON_ARRAY_END, false);
+            case '"': {
+                size_t start = ++m_pos;
+                while (m_pos < n && s[m_pos] != '"') {
+                    if (s[m_pos] == '\\') { tok.escaped = true; ++m_pos; }
+                    ++m_pos;
+                }
+                if (m_pos >= n) return fail(tok);
+                tok.type = m_want_key ? JSON_KEY : JSON_STRING;
+                tok.text = string_view(s + start, m_pos - start);
+                ++m_pos;
+                m_want_key = false;
+                return true;
+            }
+            case 't': case 'f': case 'n': {
+                const char* word = c == 't' ? "true" : c == 'f' ? "false" : "null";
+                size_t len = c == 'f' ? 5 : 4;
+                if (n - m_pos < len || memcmp(s + m_pos, word, len) != 0) return fail(tok);
+                tok.type = c == 't' ? JSON_TRUE : c == 'f' ? JSON_FALSE : JSON_NULL;
+                tok.text = string_view(s + m_pos, len);
+                m_pos += len;
+                return true;
+            }
+            default: {
+                size_t start = m_pos;
+                while (m_pos < n) {
+                    char d = s[m_pos];
+                    if ((d >= '0' && d <= '9') || d == '-' || d == '+' || d == '.' || d == 'e' || d == 'E') ++m_pos;
+                    else break;
+                }
+                if (m_pos == start) return fail(tok);
+                tok.type = JSON_NUMBER;
+                tok.text = string_view(s + start, m_pos - start);
+                return true;
+            }
+        }
+    }
+
+    // Look up a dotted path such as "sensor.temp" or "readings.2.value"
+    // (numeric segments index arrays) in one pass from the start of the
+    // input, skipping unrelated subtrees without descending into them.
+    // An empty path selects the root value.
+    bool get(const string_view& path, JsonToken& out) {
+        reset();
+        JsonToken tok;
+        if (!next(tok)) return false;
+
+        size_t seg_start = 0;
+        bool more = path.size() > 0;
+        while (more) {
+            const char* dot = static_cast<const char*>(memchr(path.data() + seg_start, '.', path.size() - seg_start));
+            size_t seg_end = dot ? static_cast<size_t>(dot - path.data()) : path.size();
+            string_view seg(path.data() + seg_start, seg_end - seg_start);
+            seg_start = seg_end + 1;
+            more = dot != nullptr;
+
+            if (tok.type == JSON_OBJECT_START) {
+                for (;;) {
+                    if (!next(tok) || tok.type == JSON_OBJECT_END) return false;
+                    bool hit = keyEquals(tok, seg);
+                    if (!next(tok)) return false;
+                    if (hit) break;
+                    JsonToken last;
+                    if (!skipValue(tok, last)) return false;
+                }
+            } else if (tok.type == JSON_ARRAY_START) {
+                size_t index = 0;
+                if (seg.size() == 0) return false;
+                for (size_t i = 0; i < seg.size(); ++i) {
+                    if (seg[i] < '0' || seg[i] > '9') return false;
+                    index = index * 10 + (seg[i] - '0');
+                }
+                for (size_t i = 0;; ++i) {
+                    if (!next(tok) || tok.type == JSON_ARRAY_END) return false;
+                    if (i == index) break;
+                    JsonToken last;
+                    if (!skipValue(tok, last)) return false;
+                }
+            } else {
+                return false;
+            }
+        }
+
+        out = tok;
+        if (tok.type == JSON_OBJECT_START || tok.type == JSON_ARRAY_START) {
+            JsonToken last;
+            if (!skipValue(tok, last)) return false;
+            out.text = string_view(tok.text.data(), last.text.data() + 1 - tok.text.data());
+        }
+        return true;
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include "mystring.hpp"
+
+// Byte of key at depth as 0..255, or -1 past the end (sorts first).
+inline int mkqs_char(const string_view& key, size_t depth) {
+    return (depth < key.size()) ? (int)(unsigned char)key[depth] : -1;
+}
+
+// Multikey (three-way radix) quicksort of an index permutation over keys.
+// Each character is inspected once per partition level, so shared prefixes
+// are not compared over and over as with a comparison sort.
+template <typename Index>
+void multikey_sort(const string_view* keys, Index* idx, size_t n, size_t depth = 0) {
+    while (n > 1) {
+        if (n < 8) {
+            // insertion sort on the remaining suffixes
+            for (size_t i = 1; i < n; ++i) {
+                for (size_t j = i; j > 0; --j) {
+                    string_view a(keys[idx[j - 1]].data() + depth, keys[idx[j - 1]].size() - depth);
+                    string_view b(keys[idx[j]].data() + depth, keys[idx[j]].size() - depth);
+                    if (a.compare(b) <= 0) break;
+                    Index t = idx[j]; idx[j] = idx[j - 1]; idx[j - 1] = t;
+                }
+            }
+            return;
+        }
+
+        int pivot = mkqs_char(keys[idx[n / 2]], depth);
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt) {
+            int c = mkqs_char(keys[idx[i]], depth);
+            if (c < pivot) { Index t = idx[lt]; idx[lt++] = idx[i]; idx[i++] = t; }
+            else if (c > pivot) { Index t = idx[--gt]; idx[gt] = idx[i]; idx[i] = t; }
+            else ++i;
+        }
+
+        multikey_sort(keys, idx, lt, depth);
+        multikey_sort(keys, idx + gt, n - gt, depth);
+        if (pivot < 0) return;  // the equal partition holds identical keys
+        idx += lt;
+        n = gt - lt;
+        ++depth;
+    }
+}
+
+// Read-only sorted map from string keys to V, built once in bulk.
+//
+// Keys live in one arena as [shared-prefix byte][suffix] entries with a
+// parallel offset array, and values in a parallel array, so a lookup
+// touches three flat arrays and never the heap. With Bucket > 1 keys are
+// front coded: every Bucket-th key is stored in full and acts as a binary
+// search head, the others store only what differs from their predecessor.
+template <typename V, size_t MaxKeys, size_t ArenaBytes, size_t Bucket = 1>
+class FlatStringMap {
+    static_assert(MaxKeys > 0 && Bucket > 0, "MaxKeys and Bucket must be at least 1");
+
+    typedef typename uint_for<ArenaBytes>::type offset_type;
+    typedef typename uint_for<MaxKeys>::type index_type;
+
+    char m_arena[ArenaBytes];
+    offset_type m_offsets[MaxKeys + 1];
+    V m_values[MaxKeys];
+    size_t m_count;
+
+    uint8_t prefixOf(size_t i) const { return static_cast<uint8_t>(m_arena[m_offsets[i]]); }
+    string_view suffixOf(size_t i) const {
+        return string_view(m_arena + m_offsets[i] + 1, m_offsets[i + 1] - m_offsets[i] - 1);
+    }
+
+    static size_t common_prefix(const string_view& a, const string_view& b) {
+        size_t n = (a.size() < b.size()) ? a.size() : b.size();
+        size_t i = 0;
+        while (i < n && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    // Index of key in the bucket starting at head, or -1. Walks the front
+    // coded entries tracking only lcp(key, current entry), so no entry is
+    // ever decoded.
+    int scanBucket(size_t head, const string_view& key) const {
+        string_view h = suffixOf(head);
+        size_t m = common_prefix(h, key);
+        if (m == key.size() && m == h.size()) return static_cast<int>(head);
+
+        size_t end = head + Bucket;
+        if (end > m_count) end = m_count;
+        for (size_t i = head + 1; i < end; ++i) {
+            size_t p = prefixOf(i);
+            if (p > m) continue;                 // entry i still sorts below key
+            if (p < m && p < 255) return -1;     // entry i already sorts above key
+            // key and entry i agree on the first p bytes; compare the rest
+            string_view suf = suffixOf(i);
+            string_view rest(key.data() + p, key.size() - p);
+            size_t ext = common_prefix(suf, rest);
+            m = p + ext;
+            if (ext == suf.size() && ext == rest.size()) return static_cast<int>(i);
+            if (ext == rest.size()) return -1;  // key is a proper prefix of entry i
+            if (ext < suf.size() && (unsigned char)suf[ext] > (unsigned char)rest[ext]) return -1;
+        }
+        return -1;
+    }
+
+public:
+    FlatStringMap() : m_count(0) { m_offsets[0] = 0; }
+
+    // Sorts keys with multikey quicksort and packs them. Duplicate keys keep
+    // the value given last. Returns false (leaving the map empty) if the
+    // keys do not fit MaxKeys/ArenaBytes.
+    bool build(const string_view* keys, const V* values, size_t count) {
+        m_count = 0;
+        m_offsets[0] = 0;
+        if (count > MaxKeys) {
+            PRINT_WARNING("ERROR: FlatStringMap has too many keys");
+            return false;
+        }
+
+        index_type order[MaxKeys];
+        for (size_t i = 0; i < count; ++i) order[i] = static_cast<index_type>(i);
+        multikey_sort(keys, order, count);
+
+        size_t used = 0;
+        string_view prev;
+        for (size_t i = 0; i < count; ++i) {
+            // among equal keys take the one that appeared last in the input
+            size_t pick = order[i];
+            while (i + 1 < count && keys[order[i + 1]] == keys[pick]) {
+                ++i;
+                if (order[i] > pick) pick = order[i];
+            }
+            const string_view& key = keys[pick];
+
+            size_t prefix = 0;
+            if (m_count % Bucket != 0) {
+                prefix = common_prefix(prev, key);
+                if (prefix > 255) prefix = 255;
+            }
+            size_t need = 1 + key.size() - prefix;
+            if (used + need > ArenaBytes) {
+                PRINT_WARNING("ERROR: FlatStringMap arena is full");
+                m_count = 0;
+                return false;
+            }
+            m_arena[used] = static_cast<char>(prefix);
+            memcpy(m_arena + used + 1, key.data() + prefix, key.size() - prefix);
+            used += need;
+            m_values[m_count] = values[pick];
+            m_offsets[++m_count] = static_cast<offset_type>(used);
+            prev = key;
+        }
+        return true;
+    }
+
+    const V* get(const string_view& key) const {
+        if (m_count == 0) return nullptr;
+        // last bucket head <= key
+        size_t heads = (m_count + Bucket - 1) / Bucket;
+        size_t lo = 0, hi = heads;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (suffixOf(mid * Bucket).compare(key) <= 0) lo = mid;
+            else hi = mid;
+        }
+        int i = scanBucket(lo * Bucket, key);
+        return (i < 0) ? nullptr : &m_values[i];
+    }
+
+    bool contains(const string_view& key) const { return get(key) != nullptr; }
+
+    // Appends key i (in sorted order) to out; front coded keys are rebuilt.
+    bool keyAt(size_t i, string& out) const {
+        if (i >= m_count) return false;
+        size_t head = i - i % Bucket;
+        size_t base = out.size();
+        out.concat(suffixOf(head));
+        for (size_t k = head + 1; k <= i; ++k) {
+            size_t keep = base + prefixOf(k);
+            if (keep > out.size()) return false;  // out truncated earlier
+            out.truncate(keep);
+            out.concat(suffixOf(k));
+        }
+        return true;
+    }
+
+    const V& valueAt(size_t i) const { return m_values[i]; }
+    size_t size() const { return m_count; }
+    size_t arenaUsed() const { return m_offsets[m_count]; }
+};
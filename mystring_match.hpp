@@ -0,0 +1,412 @@
+#pragma once
+#include "mystring.hpp"
+
+// Aho-Corasick multi-pattern matcher. The automaton is a sparse trie
+// (first-child / next-sibling) with failure and dictionary-suffix links, so
+// it costs 12 bytes per state instead of a 256-entry row. From C++14 on it
+// can be built by a constexpr call, which places the whole table in flash:
+//
+//     static constexpr const char* TOKENS[] = { "OK", "ERROR", "+CREG:" };
+//     static constexpr auto modem = makeMultiMatcher<16>(TOKENS);
+//     static_assert(!modem.overflowed(), "raise MaxStates");
+//     int id = modem.findFirst(line);
+//
+// MaxStates must cover the root plus every distinct pattern prefix; the sum
+// of the pattern lengths + 1 is always enough.
+template <size_t MaxStates, size_t MaxPatterns>
+class MultiMatcher {
+    static_assert(MaxStates > 0 && MaxStates <= 0xFFFF, "MultiMatcher supports at most 65535 states");
+
+    struct Node {
+        char label = 0;
+        uint16_t child = 0;    // first child, 0 = none (the root is never a child)
+        uint16_t sibling = 0;  // next sibling, 0 = none
+        uint16_t fail = 0;     // longest proper suffix that is also a trie path
+        uint16_t out = 0;      // pattern id + 1, 0 = not a pattern end
+        uint16_t link = 0;     // nearest state on the fail chain with out != 0
+    };
+
+    Node m_nodes[MaxStates];
+    const char* m_patterns[MaxPatterns];
+    uint16_t m_lengths[MaxPatterns];
+    size_t m_state_count;
+    size_t m_pattern_count;
+    bool m_built;
+    bool m_overflow;
+
+    MYSTRING_CONSTEXPR14 uint16_t child(size_t state, char c) const {
+        for (uint16_t n = m_nodes[state].child; n != 0; n = m_nodes[n].sibling) {
+            if (m_nodes[n].label == c) return n;
+        }
+        return 0;
+    }
+
+    // One automaton step: follow failure links until c can be consumed.
+    uint16_t step(uint16_t state, char c) const {
+        for (;;) {
+            uint16_t next = child(state, c);
+            if (next != 0 || state == 0) return next;
+            state = m_nodes[state].fail;
+        }
+    }
+
+public:
+    MYSTRING_CONSTEXPR14 MultiMatcher()
+        : m_nodes(), m_patterns(), m_lengths(), m_state_count(1), m_pattern_count(0), m_built(false), m_overflow(false) {}
+
+    // Adds a pattern before build(). Returns false for empty patterns, when
+    // the matcher is already built, or when MaxStates/MaxPatterns is too small.
+    // A duplicate pattern keeps the id of its first occurrence.
+    MYSTRING_CONSTEXPR14 bool add(const char* pattern, size_t len) {
+        if (m_built || len == 0 || len > 0xFFFF) return false;
+        if (m_pattern_count >= MaxPatterns) { m_overflow = true; return false; }
+
+        size_t state = 0;
+        size_t i = 0;
+        for (; i < len; ++i) {
+            uint16_t next = child(state, pattern[i]);
+            if (next == 0) break;
+            state = next;
+        }
+        if (m_state_count + (len - i) > MaxStates) { m_overflow = true; return false; }
+
+        for (; i < len; ++i) {
+            Node& n = m_nodes[m_state_count];
+            n.label = pattern[i];
+            n.sibling = m_nodes[state].child;
+            m_nodes[state].child = static_cast<uint16_t>(m_state_count);
+            state = m_state_count++;
+        }
+
+        m_patterns[m_pattern_count] = pattern;
+        m_lengths[m_pattern_count] = static_cast<uint16_t>(len);
+        ++m_pattern_count;
+        if (m_nodes[state].out == 0) m_nodes[state].out = static_cast<uint16_t>(m_pattern_count);
+        return true;
+    }
+
+    MYSTRING_CONSTEXPR14 bool add(const char* pattern) {
+        size_t len = 0;
+        if (pattern) while (pattern[len]) ++len;
+        return add(pattern, len);
+    }
+
+    bool add(const string_view& pattern) { return add(pattern.data(), pattern.size()); }
+
+    // Computes failure and dictionary links breadth-first. Must be called
+    // once after the last add() and before matching.
+    MYSTRING_CONSTEXPR14 void build() {
+        uint16_t queue[MaxStates] = {};
+        size_t head = 0, tail = 0;
+
+        for (uint16_t n = m_nodes[0].child; n != 0; n = m_nodes[n].sibling) {
+            m_nodes[n].fail = 0;
+            m_nodes[n].link = 0;
+            queue[tail++] = n;
+        }
+
+        while (head < tail) {
+            uint16_t u = queue[head++];
+            for (uint16_t v = m_nodes[u].child; v != 0; v = m_nodes[v].sibling) {
+                char c = m_nodes[v].label;
+                uint16_t f = m_nodes[u].fail;
+                while (f != 0 && child(f, c) == 0) f = m_nodes[f].fail;
+                uint16_t target = child(f, c);
+                m_nodes[v].fail = target;
+                m_nodes[v].link = m_nodes[target].out ? target : m_nodes[target].link;
+                queue[tail++] = v;
+            }
+        }
+        m_built = true;
+    }
+
+    bool built() const { return m_built; }
+    // True if a pattern was dropped for lack of space; usable in static_assert.
+    constexpr bool overflowed() const { return m_overflow; }
+    size_t stateCount() const { return m_state_count; }
+    size_t patternCount() const { return m_pattern_count; }
+
+    string_view pattern(size_t id) const {
+        if (id >= m_pattern_count) return string_view();
+        return string_view(m_patterns[id], m_lengths[id]);
+    }
+
+    // Single pass over text. on_match(pattern_id, start_offset) is called for
+    // every occurrence, in order of the end position. Returns the match count.
+    template <typename F>
+    size_t forEachMatch(const string_view& text, F on_match) const {
+        if (!m_built) {
+            PRINT_WARNING("ERROR: MultiMatcher used before build()");
+            return 0;
+        }
+        size_t found = 0;
+        uint16_t state = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = step(state, text[i]);
+            uint16_t t = m_nodes[state].out ? state : m_nodes[state].link;
+            while (t != 0) {
+                size_t id = m_nodes[t].out - 1;
+                on_match(id, i + 1 - m_lengths[id]);
+                ++found;
+                t = m_nodes[t].link;
+            }
+        }
+        return found;
+    }
+
+    // Id of the pattern whose occurrence ends first in text (the longest one
+    // if several end at the same byte), or -1. Stops scanning on the hit.
+    int findFirst(const string_view& text, size_t* match_pos = nullptr) const {
+        if (!m_built) {
+            PRINT_WARNING("ERROR: MultiMatcher used before build()");
+            return -1;
+        }
+        uint16_t state = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = step(state, text[i]);
+            uint16_t t = m_nodes[state].out ? state : m_nodes[state].link;
+            if (t != 0) {
+                size_t id = m_nodes[t].out - 1;
+                if (match_pos) *match_pos = i + 1 - m_lengths[id];
+                return static_cast<int>(id);
+            }
+        }
+        return -1;
+    }
+};
+
+template <size_t MaxStates, size_t N>
+MYSTRING_CONSTEXPR14 MultiMatcher<MaxStates, N> makeMultiMatcher(const char* const (&patterns)[N]) {
+    MultiMatcher<MaxStates, N> m;
+    for (size_t i = 0; i < N; ++i) m.add(patterns[i]);
+    m.build();
+    return m;
+}
+
+// Resumable Knuth-Morris-Pratt search for data that arrives in chunks
+// (DMA blocks, socket reads). A match split across two feed() calls is
+// still found. State is the prefix table plus the current match length;
+// no past input is buffered, so the pattern bytes must outlive the matcher.
+template <size_t MaxPattern>
+class StreamMatcher {
+    static_assert(MaxPattern > 0 && MaxPattern <= 0xFFFF, "StreamMatcher supports patterns up to 65535 bytes");
+
+    const char* m_pattern;
+    uint16_t m_prefix[MaxPattern];  // length of the longest proper border of pattern[0..i]
+    size_t m_len;
+    size_t m_matched;
+    size_t m_consumed;
+
+public:
+    StreamMatcher(const string_view& pattern)
+        : m_pattern(pattern.data()), m_len(pattern.size()), m_matched(0), m_consumed(0) {
+        if (m_len > MaxPattern) {
+            PRINT_WARNING("ERROR: StreamMatcher pattern longer than MaxPattern");
+            m_len = 0;
+        }
+        if (m_len == 0) return;
+
+        m_prefix[0] = 0;
+        size_t k = 0;
+        for (size_t i = 1; i < m_len; ++i) {
+            while (k > 0 && m_pattern[i] != m_pattern[k]) k = m_prefix[k - 1];
+            if (m_pattern[i] == m_pattern[k]) ++k;
+            m_prefix[i] = static_cast<uint16_t>(k);
+        }
+    }
+
+    // Feeds the next chunk. on_match(offset) receives the offset of each
+    // match start counted from the first byte ever fed; overlapping matches
+    // are reported. Returns the number of matches ending in this chunk.
+    template <typename F>
+    size_t feed(const string_view& chunk, F on_match) {
+        size_t found = 0;
+        if (m_len == 0) {
+            m_consumed += chunk.size();
+            return 0;
+        }
+        const char* d = chunk.data();
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            char c = d[i];
+            while (m_matched > 0 && c != m_pattern[m_matched]) m_matched = m_prefix[m_matched - 1];
+            if (c == m_pattern[m_matched]) ++m_matched;
+            if (m_matched == m_len) {
+                on_match(m_consumed + i + 1 - m_len);
+                ++found;
+                m_matched = m_prefix[m_len - 1];
+            }
+        }
+        m_consumed += chunk.size();
+        return found;
+    }
+
+    size_t feed(const string_view& chunk) {
+        return feed(chunk, [](size_t) {});
+    }
+
+    // Bytes of a possible match carried over from previous chunks.
+    size_t partial() const { return m_matched; }
+    size_t consumed() const { return m_consumed; }
+    string_view pattern() const { return string_view(m_pattern, m_len); }
+
+    void reset() {
+        m_matched = 0;
+        m_consumed = 0;
+    }
+};
+
+struct Route {
+    const char* prefix;
+    uint16_t handler;
+};
+
+// Radix tree (compressed trie) over route prefixes for longest-prefix
+// routing. Edge labels are copied into one arena; nodes hold an arena
+// offset/length, first child, next sibling and handler id. A lookup walks
+// one edge per matched label, so it costs O(input length) no matter how
+// many routes there are. Like MultiMatcher it can be built in a constexpr
+// context from C++14 on:
+//
+//     static constexpr Route ROUTES[] = { { "/api/", 1 }, { "/api/v2/", 2 }, { "/", 0 } };
+//     static constexpr auto router = makePrefixIndex<8, 16>(ROUTES);
+//     int handler = router.match(path);
+template <size_t MaxNodes, size_t ArenaBytes>
+class PrefixIndex {
+    static_assert(MaxNodes > 0 && MaxNodes <= 0xFFFF, "PrefixIndex supports at most 65535 nodes");
+
+public:
+    static const uint16_t NO_HANDLER = 0xFFFF;
+
+private:
+    typedef typename uint_for<ArenaBytes>::type offset_type;
+
+    struct Node {
+        offset_type label = 0;     // edge label = m_arena[label, label + len)
+        uint16_t len = 0;
+        uint16_t child = 0;        // 0 = none (the root is never a child)
+        uint16_t sibling = 0;
+        uint16_t handler = NO_HANDLER;
+    };
+
+    Node m_nodes[MaxNodes];
+    char m_arena[ArenaBytes];
+    size_t m_node_count;
+    size_t m_arena_used;
+    bool m_overflow;
+
+    // Child of node whose label starts with c (siblings have distinct first bytes).
+    MYSTRING_CONSTEXPR14 uint16_t child(size_t node, char c) const {
+        for (uint16_t n = m_nodes[node].child; n != 0; n = m_nodes[n].sibling) {
+            if (m_arena[m_nodes[n].label] == c) return n;
+        }
+        return 0;
+    }
+
+public:
+    MYSTRING_CONSTEXPR14 PrefixIndex()
+        : m_nodes(), m_arena(), m_node_count(1), m_arena_used(0), m_overflow(false) {}
+
+    // Registers prefix -> handler; re-adding a prefix replaces its handler.
+    // The empty prefix sets the fallback handler. Returns false when
+    // MaxNodes or ArenaBytes is too small.
+    MYSTRING_CONSTEXPR14 bool add(const char* prefix, size_t len, uint16_t handler) {
+        size_t node = 0;
+        size_t pos = 0;
+        while (pos < len) {
+            uint16_t c = child(node, prefix[pos]);
+            if (c == 0) {
+                // new leaf holding the rest of the prefix
+                size_t rest = len - pos;
+                if (m_node_count >= MaxNodes || m_arena_used + rest > ArenaBytes || rest > 0xFFFF) {
+                    m_overflow = true;
+                    return false;
+                }
+                for (size_t i = 0; i < rest; ++i) m_arena[m_arena_used + i] = prefix[pos + i];
+                Node& leaf = m_nodes[m_node_count];
+                leaf.label = static_cast<offset_type>(m_arena_used);
+                leaf.len = static_cast<uint16_t>(rest);
+                leaf.sibling = m_nodes[node].child;
+                m_nodes[node].child = static_cast<uint16_t>(m_node_count);
+                m_arena_used += rest;
+                node = m_node_count++;
+                pos = len;
+                break;
+            }
+
+            size_t l = 0;
+            while (l < m_nodes[c].len && pos + l < len && m_arena[m_nodes[c].label + l] == prefix[pos + l]) ++l;
+            if (l < m_nodes[c].len) {
+                // split edge c after l bytes; the new middle node reuses the
+                // first l bytes of c's label, so the arena does not grow
+                if (m_node_count >= MaxNodes) {
+                    m_overflow = true;
+                    return false;
+                }
+                Node& mid = m_nodes[m_node_count];
+                mid.label = m_nodes[c].label;
+                mid.len = static_cast<uint16_t>(l);
+                mid.child = c;
+                mid.sibling = m_nodes[c].sibling;
+                if (m_nodes[node].child == c) {
+                    m_nodes[node].child = static_cast<uint16_t>(m_node_count);
+                } else {
+                    uint16_t prev = m_nodes[node].child;
+                    while (m_nodes[prev].sibling != c) prev = m_nodes[prev].sibling;
+                    m_nodes[prev].sibling = static_cast<uint16_t>(m_node_count);
+                }
+                m_nodes[c].label = static_cast<offset_type>(m_nodes[c].label + l);
+                m_nodes[c].len = static_cast<uint16_t>(m_nodes[c].len - l);
+                m_nodes[c].sibling = 0;
+                c = static_cast<uint16_t>(m_node_count++);
+            }
+            node = c;
+            pos += l;
+        }
+        m_nodes[node].handler = handler;
+        return true;
+    }
+
+    MYSTRING_CONSTEXPR14 bool add(const char* prefix, uint16_t handler) {
+        size_t len = 0;
+        if (prefix) while (prefix[len]) ++len;
+        return add(prefix, len, handler);
+    }
+
+    bool add(const string_view& prefix, uint16_t handler) {
+        return add(prefix.data(), prefix.size(), handler);
+    }
+
+    // Handler of the longest registered prefix of input, or -1 if none
+    // matches. matched_len receives the length of that prefix.
+    int match(const string_view& input, size_t* matched_len = nullptr) const {
+        int best = (m_nodes[0].handler != NO_HANDLER) ? m_nodes[0].handler : -1;
+        size_t best_len = 0;
+        size_t node = 0;
+        size_t pos = 0;
+        while (pos < input.size()) {
+            uint16_t c = child(node, input[pos]);
+            if (c == 0) break;
+            const Node& n = m_nodes[c];
+            if (input.size() - pos < n.len || memcmp(m_arena + n.label, input.data() + pos, n.len) != 0) break;
+            pos += n.len;
+            node = c;
+            if (n.handler != NO_HANDLER) {
+                best = n.handler;
+                best_len = pos;
+            }
+        }
+        if (matched_len && best >= 0) *matched_len = best_len;
+        return best;
+    }
+
+    constexpr bool overflowed() const { return m_overflow; }
+    size_t nodeCount() const { return m_node_count; }
+    size_t arenaUsed() const { return m_arena_used; }
+};
+
+template <size_t MaxNodes, size_t ArenaBytes, size_t N>
+MYSTRING_CONSTEXPR14 PrefixIndex<MaxNodes, ArenaBytes> makePrefixIndex(const Route (&routes)[N]) {
+    PrefixIndex<MaxNodes, ArenaBytes> index;
+    for (size_t i = 0; i < N; ++i) index.add(routes[i].prefix, routes[i].handler);
+    return index;
+}
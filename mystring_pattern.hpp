@@ -0,0 +1,183 @@
+#pragma once
+#include "mystring.hpp"
+
+// Wildcard matchers that compile their pattern once (in a constexpr context
+// from C++14 on) into a short op list, then match without allocation or
+// recursion. The pattern text is referenced, not copied, so it must outlive
+// the matcher; string literals always do.
+
+// MQTT topic filter: '+' matches exactly one level, '#' (last level only)
+// matches the parent level and everything below it. Wildcards in the first
+// level never match topics starting with '$', as the MQTT spec requires.
+//
+//     static constexpr TopicFilter<4> temps("sensors/+/temp");
+//     if (temps.matches(topic)) ...
+template <size_t MaxLevels>
+class TopicFilter {
+    enum OpKind : uint8_t { LEVEL, ANY_LEVEL, REST };
+    struct Op {
+        uint8_t kind = LEVEL;
+        uint16_t offset = 0;
+        uint16_t len = 0;
+    };
+
+    const char* m_pattern;
+    Op m_ops[MaxLevels];
+    size_t m_count;
+    bool m_valid;
+
+public:
+    MYSTRING_CONSTEXPR14 TopicFilter(const char* filter, size_t len)
+        : m_pattern(filter), m_ops(), m_count(0), m_valid(len > 0 && len <= 0xFFFF) {
+        size_t start = 0;
+        for (size_t i = 0; m_valid && i <= len; ++i) {
+            if (i < len && filter[i] != '/') continue;
+            size_t level = i - start;
+            if (m_count == MaxLevels) { m_valid = false; break; }
+            Op& op = m_ops[m_count++];
+            if (level == 1 && filter[start] == '+') {
+                op.kind = ANY_LEVEL;
+            } else if (level == 1 && filter[start] == '#') {
+                op.kind = REST;
+                if (i != len) m_valid = false;  // '#' must be the last level
+            } else {
+                for (size_t k = start; k < i; ++k) {
+                    if (filter[k] == '+' || filter[k] == '#') m_valid = false;
+                }
+                op.kind = LEVEL;
+                op.offset = static_cast<uint16_t>(start);
+                op.len = static_cast<uint16_t>(level);
+            }
+            start = i + 1;
+        }
+    }
+
+    template <size_t N>
+    MYSTRING_CONSTEXPR14 TopicFilter(const char (&filter)[N]) : TopicFilter(filter, array_text_len(filter, N)) {}
+    TopicFilter(const string_view& filter) : TopicFilter(filter.data(), filter.size()) {}
+
+    // False for malformed filters ("a/#/b", "a+/b") or too many levels.
+    constexpr bool valid() const { return m_valid; }
+
+    bool matches(const string_view& topic) const {
+        if (!m_valid) return false;
+        const char* p = topic.data();
+        const char* end = p + topic.size();
+        if (topic.size() > 0 && p[0] == '$' && m_ops[0].kind != LEVEL) return false;
+
+        bool exhausted = false;  // true once the last topic level is consumed
+        for (size_t i = 0; i < m_count; ++i) {
+            const Op& op = m_ops[i];
+            if (op.kind == REST) return true;
+            if (exhausted) return false;
+
+            const char* slash = static_cast<const char*>(memchr(p, '/', end - p));
+            const char* level_end = slash ? slash : end;
+            if (op.kind == LEVEL) {
+                size_t level = level_end - p;
+                if (level != op.len || memcmp(p, m_pattern + op.offset, level) != 0) return false;
+            }
+            if (slash) p = slash + 1;
+            else exhausted = true;
+        }
+        return exhausted;
+    }
+};
+
+// Shell-style glob: '*' matches any run of characters (including '/'),
+// '?' matches exactly one. The pattern compiles into its '*'-separated
+// segments; matching anchors the first and last segments and places the
+// middle ones greedily at their leftmost occurrence, which is always
+// correct for globs and never backtracks to an earlier segment.
+//
+// It is not strictly linear: each middle segment is found by trying every
+// start position, so the worst case is O(text length * total segment
+// length), e.g. "*aaab*" against a long run of 'a'. Without '*' or with
+// single-character segments it is one pass over the text. A guaranteed
+// linear search that honours '?' needs a per-byte mask table (2 KB for
+// Shift-And) per matcher, more than this header spends on small parts.
+template <size_t MaxSegments>
+class GlobPattern {
+    struct Segment {
+        uint16_t offset = 0;
+        uint16_t len = 0;
+    };
+
+    const char* m_pattern;
+    Segment m_segments[MaxSegments];
+    size_t m_count;
+    bool m_leading_star;
+    bool m_trailing_star;
+    bool m_valid;
+
+    bool segmentAt(const Segment& seg, const char* text) const {
+        const char* pat = m_pattern + seg.offset;
+        for (size_t i = 0; i < seg.len; ++i) {
+            if (pat[i] != '?' && pat[i] != text[i]) return false;
+        }
+        return true;
+    }
+
+public:
+    MYSTRING_CONSTEXPR14 GlobPattern(const char* pattern, size_t len)
+        : m_pattern(pattern), m_segments(), m_count(0),
+          m_leading_star(len > 0 && pattern[0] == '*'),
+          m_trailing_star(len > 0 && pattern[len - 1] == '*'),
+          m_valid(len <= 0xFFFF) {
+        size_t start = 0;
+        for (size_t i = 0; m_valid && i <= len; ++i) {
+            if (i < len && pattern[i] != '*') continue;
+            if (i > start) {  // runs of '*' and the ends produce no segment
+                if (m_count == MaxSegments) { m_valid = false; break; }
+                m_segments[m_count].offset = static_cast<uint16_t>(start);
+                m_segments[m_count].len = static_cast<uint16_t>(i - start);
+                ++m_count;
+            }
+            start = i + 1;
+        }
+    }
+
+    template <size_t N>
+    MYSTRING_CONSTEXPR14 GlobPattern(const char (&pattern)[N]) : GlobPattern(pattern, array_text_len(pattern, N)) {}
+    GlobPattern(const string_view& pattern) : GlobPattern(pattern.data(), pattern.size()) {}
+
+    constexpr bool valid() const { return m_valid; }
+
+    bool matches(const string_view& text) const {
+        if (!m_valid) return false;
+        const char* t = text.data();
+        size_t n = text.size();
+
+        bool has_star = m_leading_star || m_trailing_star || m_count > 1;
+        if (!has_star) {
+            if (m_count == 0) return n == 0;
+            return n == m_segments[0].len && segmentAt(m_segments[0], t);
+        }
+
+        size_t first = 0, last = m_count;
+        size_t lo = 0, hi = n;
+        if (!m_leading_star && m_count > 0) {
+            const Segment& s = m_segments[0];
+            if (s.len > n || !segmentAt(s, t)) return false;
+            lo = s.len;
+            first = 1;
+        }
+        if (!m_trailing_star && last > first) {
+            const Segment& s = m_segments[last - 1];
+            if (s.len > hi - lo || !segmentAt(s, t + n - s.len)) return false;
+            hi = n - s.len;
+            --last;
+        }
+        for (size_t i = first; i < last; ++i) {
+            const Segment& s = m_segments[i];
+            bool found = false;
+            while (lo + s.len <= hi) {
+                if (segmentAt(s, t + lo)) { found = true; break; }
+                ++lo;
+            }
+            if (!found) return false;
+            lo += s.len;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include "mystring.hpp"
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+
+// Push-driven message pipelines built from C++20 coroutines. A stage is a
+// coroutine returning PipeStage that loops on co_await receive(item); the
+// owner of a stage feeds it with push(), which runs the stage until it
+// waits for the next item. Stages push to each other, so a connection is a
+// chain: bytes -> framer -> handler.
+//
+//     PipeStage handler(Counters& c) {
+//         string_view msg;
+//         while (co_await receive(msg)) c.add(msg);
+//     }
+//
+//     PipeStage sink = handler(counters);
+//     PipeStage framer = lineFramer<256>(sink);
+//     framer.push(chunk);      // as bytes arrive, any split
+//     framer.close();          // end of stream; closes sink too
+//
+// Frames that lie inside one chunk are passed on as views into it, without
+// copying. Only a frame split across chunks is gathered, in a fixed buffer
+// inside the framer, so each connection holds bounded state: the coroutine
+// frames, allocated once when the stage is created. Views are valid only
+// until the receiving stage next waits. Stages run on the pushing thread
+// and must not be pushed to from inside themselves.
+
+class PipeStage {
+public:
+    struct promise_type {
+        string_view item;
+        bool closed = false;
+
+        PipeStage get_return_object() { return PipeStage(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }  // run up to the first receive
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    PipeStage() : m_handle(nullptr) {}
+    PipeStage(PipeStage&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    PipeStage& operator=(PipeStage&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    PipeStage(const PipeStage&) = delete;
+    PipeStage& operator=(const PipeStage&) = delete;
+    ~PipeStage() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    // True once the stage has returned; it then ignores further input.
+    bool done() const { return !m_handle || m_handle.done(); }
+
+    // Hands item to the stage and runs it until it waits again. Returns
+    // false if the stage had already finished.
+    bool push(const string_view& item) {
+        if (done()) return false;
+        m_handle.promise().item = item;
+        m_handle.resume();
+        return true;
+    }
+
+    // Ends the stream: the pending receive returns false.
+    void close() {
+        if (done()) return;
+        m_handle.promise().closed = true;
+        m_handle.resume();
+    }
+
+private:
+    explicit PipeStage(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// co_await receive(item): waits for the next push. Returns false when the
+// stream is closed.
+class receive {
+    string_view& m_out;
+    PipeStage::promise_type* m_promise;
+
+public:
+    explicit receive(string_view& out) : m_out(out), m_promise(nullptr) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<PipeStage::promise_type> h) noexcept { m_promise = &h.promise(); }
+    bool await_resume() const noexcept {
+        if (m_promise->closed) return false;
+        m_out = m_promise->item;
+        return true;
+    }
+};
+
+struct FrameStats {
+    size_t frames = 0;   // passed downstream
+    size_t copied = 0;   // of those, gathered across chunks
+    size_t dropped = 0;  // longer than the framer's limit
+};
+
+// Splits a byte stream on '\n' and passes each line on, without the "\n"
+// or "\r\n". Lines longer than MaxLine are dropped up to the next newline;
+// an unterminated last line is dropped at close. out (and stats) must
+// outlive the framer.
+template <size_t MaxLine>
+PipeStage lineFramer(PipeStage& out, FrameStats* stats = nullptr) {
+    FrameStats unused;
+    FrameStats& st = stats ? *stats : unused;
+    FixedString<MaxLine + 1> carry;  // start of a line split across chunks, '\r' included
+    bool skipping = false;           // inside an over-long line
+    string_view chunk;
+    while (co_await receive(chunk)) {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+        while (p < end) {
+            const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            size_t len = static_cast<size_t>((nl ? nl : end) - p);
+            if (skipping) {
+                // Discard until the newline that ends the over-long line.
+            } else if (carry.size() + len > MaxLine + 1) {
+                skipping = true;
+                carry.clear();
+                ++st.dropped;
+            } else if (!nl) {
+                carry.concat(string_view(p, len));
+            } else {
+                string_view line(p, len);
+                if (carry.size() > 0) {
+                    carry.concat(line);
+                    line = carry;
+                    ++st.copied;
+                }
+                if (line.size() > 0 && line[line.size() - 1] == '\r') line = line.removeSuffix(1);
+                if (line.size() <= MaxLine) {
+                    ++st.frames;
+                    out.push(line);
+                } else {
+                    ++st.dropped;
+                }
+                carry.clear();
+            }
+            if (!nl) break;
+            skipping = false;
+            p = nl + 1;
+        }
+    }
+    out.close();
+}
+
+// Splits a byte stream into messages that each start with a PrefixBytes
+// big-endian length (1, 2 or 4 bytes) and passes the bodies on. Messages
+// longer than MaxFrame are skipped, so the stream stays in sync.
+template <size_t MaxFrame, size_t PrefixBytes = 2>
+PipeStage lengthFramer(PipeStage& out, FrameStats* stats = nullptr) {
+    static_assert(PrefixBytes == 1 || PrefixBytes == 2 || PrefixBytes == 4, "length prefix is 1, 2 or 4 bytes");
+    FrameStats unused;
+    FrameStats& st = stats ? *stats : unused;
+    FixedString<MaxFrame> carry;  // start of a body split across chunks
+    size_t header_have = 0;       // prefix bytes seen so far
+    uint32_t body_len = 0;
+    size_t skip = 0;              // bytes left of an oversized body
+    bool in_body = false;
+    string_view chunk;
+    while (co_await receive(chunk)) {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+        while (p < end) {
+            size_t avail = static_cast<size_t>(end - p);
+            if (skip > 0) {
+                size_t n = (avail < skip) ? avail : skip;
+                skip -= n;
+                p += n;
+            } else if (!in_body) {
+                body_len = (body_len << 8) | static_cast<uint8_t>(*p++);
+                if (++header_have < PrefixBytes) continue;
+                header_have = 0;
+                if (body_len > MaxFrame) {
+                    skip = body_len;
+                    ++st.dropped;
+                    body_len = 0;
+                    continue;
+                }
+                in_body = true;
+                if (body_len == 0) {
+                    ++st.frames;
+                    out.push(string_view(p, 0));
+                    in_body = false;
+                }
+            } else if (carry.size() == 0 && avail >= body_len) {
+                ++st.frames;
+                out.push(string_view(p, body_len));
+                p += body_len;
+                body_len = 0;
+                in_body = false;
+            } else {
+                size_t want = body_len - carry.size();
+                size_t n = (avail < want) ? avail : want;
+                carry.concat(string_view(p, n));
+                p += n;
+                if (carry.size() == body_len) {
+                    ++st.frames;
+                    ++st.copied;
+                    out.push(carry);
+                    carry.clear();
+                    body_len = 0;
+                    in_body = false;
+                }
+            }
+        }
+    }
+    out.close();
+}
+
+#endif
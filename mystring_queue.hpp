@@ -0,0 +1,113 @@
+#pragma once
+#include "mystring.hpp"
+
+#ifndef ARDUINO
+#include <atomic>
+#endif
+
+// Head/tail counter shared between one producer and one consumer. On the
+// host this is std::atomic; on a single-core MCU a byte-sized counter with
+// acquire/release ordering is enough, so the GCC builtins are used directly.
+class spsc_counter {
+#ifndef ARDUINO
+    std::atomic<size_t> m_value;
+public:
+    typedef size_t value_type;
+    spsc_counter() : m_value(0) {}
+    value_type load_acquire() const { return m_value.load(std::memory_order_acquire); }
+    value_type load_relaxed() const { return m_value.load(std::memory_order_relaxed); }
+    void store_release(value_type v) { m_value.store(v, std::memory_order_release); }
+#else
+    uint8_t m_value;
+public:
+    typedef uint8_t value_type;
+    spsc_counter() : m_value(0) {}
+    value_type load_acquire() const { return __atomic_load_n(&m_value, __ATOMIC_ACQUIRE); }
+    value_type load_relaxed() const { return __atomic_load_n(&m_value, __ATOMIC_RELAXED); }
+    void store_release(value_type v) { __atomic_store_n(&m_value, v, __ATOMIC_RELEASE); }
+#endif
+};
+
+// Lock-free single-producer/single-consumer ring of FixedString<N> slots for
+// handing lines from an ISR (or thread) to the main loop without copying:
+//
+//     // producer (ISR)                    // consumer (loop)
+//     string* slot = q.claim();            string_view line;
+//     if (slot) {                          while (q.peek(line)) {
+//         slot->concat(string_view(rx, n));    handle(line);
+//         q.publish();                         q.release();
+//     }                                    }
+//
+// The producer owns a slot from claim() until publish(); the consumer owns
+// it from peek() until release(). Slots must be a power of two.
+template <size_t N, size_t Slots>
+class SpscStringQueue {
+    static_assert(Slots > 1 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+#ifdef ARDUINO
+    static_assert(Slots <= 128, "Slots must fit the 8-bit counters used on MCUs");
+#endif
+
+    typedef spsc_counter::value_type index_type;
+
+    FixedString<N> m_slots[Slots];
+#ifndef ARDUINO
+    // keep the two counters on separate cache lines so the threads don't
+    // fight over the same line on every push/pop
+    alignas(64) spsc_counter m_head;  // written by the producer only
+    alignas(64) spsc_counter m_tail;  // written by the consumer only
+#else
+    spsc_counter m_head;
+    spsc_counter m_tail;
+#endif
+
+public:
+    SpscStringQueue() {}
+    SpscStringQueue(const SpscStringQueue&) = delete;
+    SpscStringQueue& operator=(const SpscStringQueue&) = delete;
+
+    // Producer: returns an empty slot to write into, or nullptr if the queue
+    // is full. Calling claim() again before publish() returns the same slot.
+    string* claim() {
+        index_type head = m_head.load_relaxed();
+        if (static_cast<index_type>(head - m_tail.load_acquire()) == Slots) return nullptr;
+        string* slot = &m_slots[head & (Slots - 1)];
+        slot->clear();
+        return slot;
+    }
+
+    // Producer: makes the claimed slot visible to the consumer.
+    void publish() {
+        m_head.store_release(static_cast<index_type>(m_head.load_relaxed() + 1));
+    }
+
+    // Producer: claim + copy + publish in one call. Returns false when full.
+    bool push(const string_view& line) {
+        string* slot = claim();
+        if (!slot) return false;
+        slot->concat(line);
+        publish();
+        return true;
+    }
+
+    // Consumer: views the oldest published line without copying it. The view
+    // stays valid until release().
+    bool peek(string_view& out) const {
+        index_type tail = m_tail.load_relaxed();
+        if (tail == m_head.load_acquire()) return false;
+        const FixedString<N>& slot = m_slots[tail & (Slots - 1)];
+        out = string_view(slot.c_str(), slot.size());
+        return true;
+    }
+
+    // Consumer: hands the slot returned by peek() back to the producer.
+    void release() {
+        m_tail.store_release(static_cast<index_type>(m_tail.load_relaxed() + 1));
+    }
+
+    // Approximate when called from outside the producer or consumer.
+    size_t size() const {
+        return static_cast<index_type>(m_head.load_acquire() - m_tail.load_acquire());
+    }
+    bool empty() const { return size() == 0; }
+    static size_t capacity() { return Slots; }
+};
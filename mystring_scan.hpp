@@ -0,0 +1,268 @@
+#pragma once
+#include "mystring.hpp"
+
+#if __cplusplus >= 202002L
+#include <limits>
+#include <type_traits>
+
+// Compile-time scanf for line protocols. The pattern is split into literals
+// and conversions when the template is instantiated, and the argument types
+// are checked against it, so a call is a fixed sequence of literal compares
+// and typed parsers over the view: no allocation, no terminator needed.
+//
+//     float t; int h; unsigned id;
+//     ScanResult r = scan<"T=%f,H=%d,ID=%u">(line, t, h, id);
+//     if (r.complete) ...
+//
+// Conversions:
+//     %d  signed integer          %u  unsigned decimal
+//     %x  unsigned hex            %f  float or double
+//     %c  one char                %s  string_view (or string, copied)
+//     %%  a literal '%'
+// %s stops at the first character of the literal that follows it, or takes
+// the rest of the input at the end of the pattern. Literals match exactly;
+// no whitespace is skipped.
+
+struct ScanResult {
+    size_t count;     // fields stored, left to right
+    size_t position;  // offset just past the last literal or field matched
+    bool complete;    // the whole pattern matched (input may continue)
+};
+
+// Pattern literal usable as a template argument.
+template <size_t N>
+struct ScanPattern {
+    char text[N];
+    constexpr ScanPattern(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) text[i] = s[i];
+    }
+};
+
+enum ScanPatternError { SCAN_PATTERN_OK, SCAN_BAD_CONVERSION, SCAN_UNBOUNDED_TEXT };
+
+// Compiled form: the literal before each conversion, then a tail literal.
+// Literals are stored with %% already collapsed.
+template <size_t N>
+struct scan_program {
+    struct step {
+        char conv;
+        size_t lit_begin;
+        size_t lit_len;
+    };
+    step steps[N];
+    char lit[N];
+    size_t fields;
+    size_t tail_begin;
+    size_t tail_len;
+    ScanPatternError error;
+
+    // The byte that ends %s at step k (0-255, so UTF-8 units stay
+    // positive), or -1 for the rest of the input.
+    constexpr int stopChar(size_t k) const {
+        if (k + 1 < fields) {
+            return steps[k + 1].lit_len ? static_cast<unsigned char>(lit[steps[k + 1].lit_begin]) : -1;
+        }
+        return tail_len ? static_cast<unsigned char>(lit[tail_begin]) : -1;
+    }
+};
+
+template <size_t N>
+constexpr scan_program<N> scan_compile(const ScanPattern<N>& pattern) {
+    scan_program<N> prog{};
+    size_t out = 0, begin = 0;
+    for (size_t i = 0; i + 1 < N; ++i) {
+        char c = pattern.text[i];
+        if (c != '%') {
+            prog.lit[out++] = c;
+            continue;
+        }
+        char conv = pattern.text[++i];
+        if (conv == '%') {
+            prog.lit[out++] = '%';
+            continue;
+        }
+        if (conv != 'd' && conv != 'u' && conv != 'x' && conv != 'f' && conv != 'c' && conv != 's') {
+            prog.error = SCAN_BAD_CONVERSION;
+            return prog;
+        }
+        if (prog.fields > 0 && prog.steps[prog.fields - 1].conv == 's' && out == begin) {
+            prog.error = SCAN_UNBOUNDED_TEXT;
+            return prog;
+        }
+        prog.steps[prog.fields++] = {conv, begin, out - begin};
+        begin = out;
+    }
+    prog.tail_begin = begin;
+    prog.tail_len = out - begin;
+    return prog;
+}
+
+template <ScanPattern P>
+inline constexpr auto scan_program_v = scan_compile(P);
+
+inline bool scan_literal(const char*& p, const char* end, const char* lit, size_t len) {
+    if (static_cast<size_t>(end - p) < len) return false;
+    for (size_t i = 0; i < len; ++i) {  // separators are a few bytes
+        if (p[i] != lit[i]) return false;
+    }
+    p += len;
+    return true;
+}
+
+// At least one digit; false on overflow.
+inline bool scan_digits(const char*& p, const char* end, unsigned base, unsigned long long& value) {
+    const char* s = p;
+    unsigned long long v = 0;
+    for (; s < end; ++s) {
+        int d = (base == 16) ? hex_value(*s) : (*s >= '0' && *s <= '9') ? *s - '0' : -1;
+        if (d < 0) break;
+        if (v > (~0ULL - static_cast<unsigned>(d)) / base) return false;
+        v = v * base + static_cast<unsigned>(d);
+    }
+    if (s == p) return false;
+    value = v;
+    p = s;
+    return true;
+}
+
+// Decimal with optional fraction and exponent. Exact for up to 15
+// significant digits and exponents within +-22, which covers sensor
+// readings; longer inputs may be off by an ulp or so.
+inline bool scan_double(const char*& p, const char* end, double& value) {
+    static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* s = p;
+    bool neg = false;
+    if (s < end && (*s == '-' || *s == '+')) neg = *s++ == '-';
+    uint64_t mant = 0;
+    int digits = 0, exp10 = 0;
+    bool any = false;
+    for (; s < end && *s >= '0' && *s <= '9'; ++s) {
+        any = true;
+        if (digits < 19) {
+            mant = mant * 10 + static_cast<unsigned>(*s - '0');
+            if (mant) ++digits;
+        } else {
+            ++exp10;
+        }
+    }
+    if (s < end && *s == '.') {
+        for (++s; s < end && *s >= '0' && *s <= '9'; ++s) {
+            any = true;
+            if (digits < 19) {
+                mant = mant * 10 + static_cast<unsigned>(*s - '0');
+                if (mant) ++digits;
+                --exp10;
+            }
+        }
+    }
+    if (!any) return false;
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool eneg = false;
+        if (e < end && (*e == '-' || *e == '+')) eneg = *e++ == '-';
+        if (e < end && *e >= '0' && *e <= '9') {
+            int x = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; ++e) {
+                if (x < 10000) x = x * 10 + (*e - '0');
+            }
+            exp10 += eneg ? -x : x;
+            s = e;
+        }
+    }
+    double v = static_cast<double>(mant);
+    if (mant != 0) {
+        for (; exp10 > 22; exp10 -= 22) v *= 1e22;
+        for (; exp10 < -22; exp10 += 22) v /= 1e22;
+        v = (exp10 < 0) ? v / POW10[-exp10] : v * POW10[exp10];
+    }
+    value = neg ? -v : v;
+    p = s;
+    return true;
+}
+
+template <char Conv, int Stop, typename T>
+bool scan_field(const char*& p, const char* end, T& value) {
+    if constexpr (Conv == 'd') {
+        static_assert(std::is_integral_v<T> && std::is_signed_v<T>, "%d needs a signed integer");
+        const char* s = p;
+        bool neg = false;
+        if (s < end && (*s == '-' || *s == '+')) neg = *s++ == '-';
+        unsigned long long mag;
+        if (!scan_digits(s, end, 10, mag)) return false;
+        unsigned long long max = static_cast<unsigned long long>(std::numeric_limits<T>::max());
+        if (mag > max + (neg ? 1 : 0)) return false;
+        value = static_cast<T>(neg ? 0 - mag : mag);  // modular since C++20
+        p = s;
+        return true;
+    } else if constexpr (Conv == 'u' || Conv == 'x') {
+        static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+                      "%u and %x need an unsigned integer");
+        const char* s = p;
+        unsigned long long v;
+        if (!scan_digits(s, end, Conv == 'x' ? 16 : 10, v) || v > std::numeric_limits<T>::max()) return false;
+        value = static_cast<T>(v);
+        p = s;
+        return true;
+    } else if constexpr (Conv == 'f') {
+        static_assert(std::is_floating_point_v<T>, "%f needs a float or double");
+        double v;
+        if (!scan_double(p, end, v)) return false;
+        value = static_cast<T>(v);
+        return true;
+    } else if constexpr (Conv == 'c') {
+        static_assert(std::is_same_v<T, char>, "%c needs a char");
+        if (p == end) return false;
+        value = *p++;
+        return true;
+    } else {
+        static_assert(std::is_same_v<T, string_view> || std::is_base_of_v<string, T>,
+                      "%s needs a string_view or a string");
+        const char* s = p;
+        if constexpr (Stop >= 0) {
+            while (s < end && *s != static_cast<char>(Stop)) ++s;
+        } else {
+            s = end;
+        }
+        if constexpr (std::is_same_v<T, string_view>) {
+            value = string_view(p, static_cast<size_t>(s - p));
+        } else {
+            value.assign(p, static_cast<size_t>(s - p));
+            if (value.size() != static_cast<size_t>(s - p)) return false;
+        }
+        p = s;
+        return true;
+    }
+}
+
+template <ScanPattern P, size_t K>
+void scan_steps(const char*& p, const char* end, ScanResult& r) {
+    constexpr const auto& prog = scan_program_v<P>;
+    if (scan_literal(p, end, prog.lit + prog.tail_begin, prog.tail_len)) r.complete = true;
+}
+
+template <ScanPattern P, size_t K, typename T, typename... Rest>
+void scan_steps(const char*& p, const char* end, ScanResult& r, T& value, Rest&... rest) {
+    constexpr const auto& prog = scan_program_v<P>;
+    constexpr auto step = prog.steps[K];
+    if (!scan_literal(p, end, prog.lit + step.lit_begin, step.lit_len)) return;
+    if (!scan_field<step.conv, prog.stopChar(K)>(p, end, value)) return;
+    ++r.count;
+    scan_steps<P, K + 1>(p, end, r, rest...);
+}
+
+template <ScanPattern P, typename... Args>
+ScanResult scan(const string_view& input, Args&... args) {
+    constexpr const auto& prog = scan_program_v<P>;
+    static_assert(prog.error != SCAN_BAD_CONVERSION, "scan pattern: unknown conversion after '%'");
+    static_assert(prog.error != SCAN_UNBOUNDED_TEXT, "scan pattern: %s must be followed by a literal");
+    static_assert(prog.fields == sizeof...(Args), "scan pattern: one argument per conversion");
+
+    ScanResult r = {0, 0, false};
+    const char* p = input.data();
+    scan_steps<P, 0>(p, input.data() + input.size(), r, args...);
+    r.position = static_cast<size_t>(p - input.data());
+    return r;
+}
+
+#endif
@@ -0,0 +1,217 @@
+#pragma once
+#include "mystring.hpp"
+
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define HAS_POSIX_FD
+#endif
+
+// Buffered output. Fragments are staged in a fixed buffer and handed to the
+// backend in one call per flush, so a log line built from ten fragments
+// costs one write()/UART transaction instead of ten. Subclasses provide the
+// storage (as a template parameter, like FixedString) and writeOut().
+class Sink {
+    protected:
+        char* m_buf;
+        size_t m_cap;
+        size_t m_used;
+
+        Sink(char* buf, size_t cap) : m_buf(buf), m_cap(cap), m_used(0) {}
+
+        // Hands len bytes to the backend. Returns false on error.
+        virtual bool writeOut(const char* data, size_t len) = 0;
+
+        // Gather version used for writes that do not fit the staging buffer.
+        virtual bool writeOutv(const string_view* parts, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (parts[i].size() > 0 && !writeOut(parts[i].data(), parts[i].size())) return false;
+            }
+            return true;
+        }
+
+        void stage(const char* data, size_t len) {
+            memcpy(m_buf + m_used, data, len);
+            m_used += len;
+        }
+
+    public:
+        Sink(const Sink&) = delete;
+        Sink& operator=(const Sink&) = delete;
+        // Subclasses flush in their own destructor; writeOut() is gone by now.
+        virtual ~Sink() {}
+
+        size_t buffered() const { return m_used; }
+        size_t capacity() const { return m_cap; }
+
+        bool flush() {
+            if (m_used == 0) return true;
+            bool ok = writeOut(m_buf, m_used);
+            m_used = 0;
+            return ok;
+        }
+
+        bool write(const string_view& sv) {
+            if (sv.size() <= m_cap - m_used) {
+                stage(sv.data(), sv.size());
+                return true;
+            }
+            if (!flush()) return false;
+            if (sv.size() <= m_cap) {
+                stage(sv.data(), sv.size());
+                return true;
+            }
+            return writeOut(sv.data(), sv.size());
+        }
+
+        bool write(char c) {
+            if (m_used == m_cap && !flush()) return false;
+            m_buf[m_used++] = c;
+            return true;
+        }
+
+        // writev-style gather: stages every part if they fit together,
+        // otherwise flushes once and passes the parts straight through.
+        bool writev(const string_view* parts, size_t count) {
+            size_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += parts[i].size();
+
+            if (total > m_cap - m_used) {
+                if (!flush()) return false;
+                if (total > m_cap) return writeOutv(parts, count);
+            }
+            for (size_t i = 0; i < count; ++i) stage(parts[i].data(), parts[i].size());
+            return true;
+        }
+
+        template <size_t N>
+        bool writev(const string_view (&parts)[N]) { return writev(parts, N); }
+
+        Sink& operator<<(const string_view& sv) { write(sv); return *this; }
+        Sink& operator<<(char c) { write(c); return *this; }
+};
+
+inline void string_view::print(Sink& sink) const { sink.write(*this); }
+
+#ifndef ARDUINO
+template <size_t N = 256>
+class StdoutSink : public Sink {
+    public:
+        StdoutSink() : Sink(storage, N) {}
+        ~StdoutSink() { flush(); }
+
+    protected:
+        bool writeOut(const char* data, size_t len) override {
+#ifdef MYSTRING_HAS_IOSTREAM
+            std::cout.write(data, len);
+            return static_cast<bool>(std::cout);
+#else
+            return fwrite(data, 1, len, stdout) == len;
+#endif
+        }
+
+    private:
+        char storage[N];
+};
+#endif
+
+#ifdef HAS_POSIX_FD
+template <size_t N = 512>
+class FdSink : public Sink {
+    public:
+        explicit FdSink(int fd) : Sink(storage, N), m_fd(fd) {}
+        ~FdSink() { flush(); }
+
+        int fd() const { return m_fd; }
+
+    protected:
+        bool writeOut(const char* data, size_t len) override {
+            while (len > 0) {
+                ssize_t n = ::write(m_fd, data, len);
+                if (n < 0) {
+                    if (errno == EINTR) continue;  // a signal, nothing written
+                    return false;
+                }
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        // One writev(2) per batch of parts instead of one write(2) per part.
+        bool writeOutv(const string_view* parts, size_t count) override {
+            const size_t BATCH = 16;
+            while (count > 0) {
+                struct iovec iov[BATCH];
+                size_t n = (count < BATCH) ? count : BATCH;
+                size_t want = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    iov[i].iov_base = const_cast<char*>(parts[i].data());
+                    iov[i].iov_len = parts[i].size();
+                    want += parts[i].size();
+                }
+                ssize_t done = ::writev(m_fd, iov, static_cast<int>(n));
+                if (done < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                if (static_cast<size_t>(done) < want) {
+                    // short write: finish this batch part by part
+                    size_t skip = static_cast<size_t>(done);
+                    for (size_t i = 0; i < n; ++i) {
+                        size_t sz = parts[i].size();
+                        if (skip >= sz) { skip -= sz; continue; }
+                        if (!writeOut(parts[i].data() + skip, sz - skip)) return false;
+                        skip = 0;
+                    }
+                }
+                parts += n;
+                count -= n;
+            }
+            return true;
+        }
+
+    private:
+        int m_fd;
+        char storage[N];
+};
+#endif
+
+#if defined(ARDUINO)
+template <size_t N = 64>
+class PrintSink : public Sink {
+    public:
+        explicit PrintSink(Print& out) : Sink(storage, N), m_out(out) {}
+        ~PrintSink() { flush(); }
+
+    protected:
+        bool writeOut(const char* data, size_t len) override {
+            return m_out.write((const uint8_t*)data, len) == len;
+        }
+
+    private:
+        Print& m_out;
+        char storage[N];
+};
+#endif
+
+// Collects output into a string (a DynamicString grows, a FixedString
+// truncates and reports failure).
+template <size_t N = 64>
+class CaptureSink : public Sink {
+    public:
+        explicit CaptureSink(string& target) : Sink(storage, N), m_target(target) {}
+        ~CaptureSink() { flush(); }
+
+    protected:
+        bool writeOut(const char* data, size_t len) override {
+            size_t before = m_target.size();
+            m_target.concat(string_view(data, len));
+            return m_target.size() == before + len;
+        }
+
+    private:
+        string& m_target;
+        char storage[N];
+};
@@ -2,10 +2,26 @@
 #include <cstring>
 #include <cassert>
 #include <string> // Only for std::cout formatting
+#include <thread>
+#include <chrono>
+#include <signal.h>
 
 // INCLUDE YOUR LIBRARY HERE
 // (If you saved it as String.hpp, uncomment the line below)
 #include "mystring.hpp" 
+#include "mystring_match.hpp"
+#include "mystring_queue.hpp"
+#include "mystring_sink.hpp"
+#include "mystring_map.hpp"
+#include "mystring_file.hpp"
+#include "mystring_pattern.hpp"
+#include "mystring_json.hpp"
+#include "mystring_batch.hpp"
+#include "mystring_fuzzy.hpp"
+#include "mystring_compress.hpp"
+#include "mystring_checksum.hpp"
+#include "mystring_scan.hpp"
+#include "mystring_pipeline.hpp"
 
 // Simple Test Framework Macros
 #define ASSERT_TRUE(condition) \
@@ -165,6 +181,1142 @@ bool Test_Polymorphism() {
     delete polyStr;
     return true;
 }
+bool Test_Utf8_Validation() {
+    string_view ascii = "plain ascii text that is longer than sixteen bytes";
+    ASSERT_TRUE(ascii.isValidUtf8());
+    ASSERT_TRUE(ascii.codepointCount() == ascii.size());
+
+    string_view mixed = "Temp: 23\xC2\xB0" "C \xE2\x82\xAC \xF0\x9F\x98\x80"; // deg, euro, emoji
+    ASSERT_TRUE(mixed.isValidUtf8());
+    ASSERT_TRUE(mixed.codepointCount() == 14);
+
+    ASSERT_TRUE(!string_view("bad \xC0\xAF").isValidUtf8());        // overlong '/'
+    ASSERT_TRUE(!string_view("bad \xED\xA0\x80").isValidUtf8());    // surrogate
+    ASSERT_TRUE(!string_view("cut \xE2\x82").isValidUtf8());        // truncated
+    ASSERT_TRUE(!string_view("0123456789abcdef\xFF").isValidUtf8()); // after fast path
+
+    uint32_t expected[] = { 'a', 0xB0, 0x20AC, 0x1F600 };
+    size_t i = 0;
+    for (uint32_t cp : string_view("a\xC2\xB0\xE2\x82\xAC\xF0\x9F\x98\x80").codepoints()) {
+        ASSERT_TRUE(i < 4 && cp == expected[i]);
+        ++i;
+    }
+    ASSERT_TRUE(i == 4);
+    return true;
+}
+
+bool Test_Utf8_Truncation() {
+    // "ab" + euro sign (3 bytes) does not fit in 4 bytes
+    FixedString<4> bytes("ab\xE2\x82\xAC", 5);
+    ASSERT_TRUE(bytes.size() == 4);
+    ASSERT_TRUE(!bytes.isValidUtf8());
+
+    FixedString<4> safe("ab\xE2\x82\xAC", 5, TRUNCATE_UTF8);
+    ASSERT_EQ_STR(safe.c_str(), "ab");
+
+    FixedString<5> appended;
+    appended.setTruncateMode(TRUNCATE_UTF8);
+    appended.concat("abc");
+    appended.concat("\xC2\xB0\xC2\xB0");
+    ASSERT_EQ_STR(appended.c_str(), "abc\xC2\xB0");
+    ASSERT_TRUE(appended.isValidUtf8());
+    return true;
+}
+#if __cplusplus >= 201402L
+static constexpr const char* MODEM_TOKENS[] = { "OK", "ERROR", "+CREG:", "RING", "ING" };
+static constexpr auto modemMatcher = makeMultiMatcher<24>(MODEM_TOKENS);
+static_assert(!modemMatcher.overflowed(), "modem token table does not fit");
+static_assert(makeMultiMatcher<20>(MODEM_TOKENS).overflowed(), "overflow must be detected");
+#endif
+
+bool Test_MultiMatcher() {
+    MultiMatcher<32, 4> m;
+    ASSERT_TRUE(m.add("he"));
+    ASSERT_TRUE(m.add("she"));
+    ASSERT_TRUE(m.add("his"));
+    ASSERT_TRUE(m.add("hers"));
+    ASSERT_TRUE(!m.add("full"));
+    ASSERT_TRUE(m.overflowed());
+    m.build();
+
+    // "ushers" contains she@1, he@2 and hers@2
+    size_t ids[4] = {0}, starts[4] = {0};
+    size_t n = 0;
+    size_t count = m.forEachMatch("ushers", [&](size_t id, size_t start) {
+        if (n < 4) { ids[n] = id; starts[n] = start; ++n; }
+    });
+    ASSERT_TRUE(count == 3 && n == 3);
+    ASSERT_TRUE(ids[0] == 1 && starts[0] == 1);
+    ASSERT_TRUE(ids[1] == 0 && starts[1] == 2);
+    ASSERT_TRUE(ids[2] == 3 && starts[2] == 2);
+
+    size_t pos = 0;
+    ASSERT_TRUE(m.findFirst("this", &pos) == 2 && pos == 1);
+    ASSERT_TRUE(m.findFirst("nothing here") == 0);
+    ASSERT_TRUE(m.findFirst("xyz") == -1);
+    ASSERT_TRUE(m.pattern(3) == "hers");
+
+#if __cplusplus >= 201402L
+    ASSERT_TRUE(modemMatcher.findFirst("+CREG: 0,1") == 2);
+    ASSERT_TRUE(modemMatcher.findFirst("\r\nRING\r\n", &pos) == 3 && pos == 2);
+    ASSERT_TRUE(modemMatcher.forEachMatch("RING", [](size_t, size_t) {}) == 2);
+#endif
+    return true;
+}
+bool Test_StreamMatcher() {
+    const char* body = "--XYZ\r\nfield\r\n--XYZ--X\r\n--XYZ";
+    StreamMatcher<16> m("\r\n--XYZ");
+
+    // feed in 3-byte chunks so every occurrence straddles a boundary
+    size_t offsets[4] = {0};
+    size_t n = 0;
+    size_t len = strlen(body);
+    for (size_t i = 0; i < len; i += 3) {
+        size_t chunk = (len - i < 3) ? len - i : 3;
+        m.feed(string_view(body + i, chunk), [&](size_t off) {
+            if (n < 4) offsets[n++] = off;
+        });
+    }
+    ASSERT_TRUE(n == 2);
+    ASSERT_TRUE(offsets[0] == 12);
+    ASSERT_TRUE(offsets[1] == 22);
+    ASSERT_TRUE(m.consumed() == len);
+
+    // overlapping matches across single-byte chunks
+    StreamMatcher<4> aa("aa");
+    size_t total = 0;
+    for (int i = 0; i < 4; ++i) total += aa.feed(string_view("a", 1));
+    ASSERT_TRUE(total == 3);
+    ASSERT_TRUE(aa.partial() == 1);
+    return true;
+}
+bool Test_SpscQueue_Basics() {
+    SpscStringQueue<8, 4> q;
+    string_view line;
+    ASSERT_TRUE(!q.peek(line));
+
+    string* slot = q.claim();
+    ASSERT_TRUE(slot != nullptr);
+    slot->concat("OK");
+    ASSERT_TRUE(q.empty()); // not visible before publish
+    q.publish();
+
+    ASSERT_TRUE(q.push("+CREG: 1"));
+    ASSERT_TRUE(q.push("RING"));
+    ASSERT_TRUE(q.push("ERROR"));
+    ASSERT_TRUE(!q.push("full"));
+    ASSERT_TRUE(q.size() == 4);
+
+    ASSERT_TRUE(q.peek(line) && line == "OK");
+    q.release();
+    ASSERT_TRUE(q.peek(line) && line == "+CREG: 1");
+    q.release();
+    ASSERT_TRUE(q.push("wrapped"));
+    ASSERT_TRUE(q.size() == 3);
+    return true;
+}
+
+bool Test_SpscQueue_Threads() {
+    static SpscStringQueue<16, 8> q;
+    const int count = 20000;
+
+    std::thread producer([]() {
+        for (int i = 0; i < count; ++i) {
+            string* slot;
+            while ((slot = q.claim()) == nullptr) std::this_thread::yield();
+            slot->concat("line ");
+            slot->concat(i);
+            q.publish();
+        }
+    });
+
+    bool in_order = true;
+    for (int i = 0; i < count; ++i) {
+        string_view line;
+        while (!q.peek(line)) std::this_thread::yield();
+        char expected[16];
+        snprintf(expected, sizeof(expected), "line %d", i);
+        if (line != expected) in_order = false;
+        q.release();
+    }
+    producer.join();
+    ASSERT_TRUE(in_order);
+    ASSERT_TRUE(q.empty());
+    return true;
+}
+class CountingSink : public Sink {
+    public:
+        CountingSink() : Sink(storage, sizeof(storage)), calls(0), out(64) {}
+        size_t calls;
+        DynamicString out;
+
+    protected:
+        bool writeOut(const char* data, size_t len) override {
+            ++calls;
+            return out.concat(string_view(data, len));
+        }
+
+    private:
+        char storage[16];
+};
+
+bool Test_Sink_Batching() {
+    CountingSink sink;
+    string_view("temp=").print(sink);
+    sink << "23" << '.' << "5" << ";";
+    ASSERT_TRUE(sink.calls == 0);
+    ASSERT_TRUE(sink.buffered() == 10);
+
+    // overflowing the 16-byte stage flushes once, then stages again
+    sink.write("hum=40;");
+    ASSERT_TRUE(sink.calls == 1);
+    sink.flush();
+    ASSERT_TRUE(sink.calls == 2);
+    ASSERT_EQ_STR(sink.out.c_str(), "temp=23.5;hum=40;");
+
+    // a gather bigger than the stage bypasses it
+    string_view parts[] = { "0123456789", "abcdefghij", "KLMNOPQRST" };
+    ASSERT_TRUE(sink.writev(parts));
+    ASSERT_TRUE(sink.buffered() == 0);
+    ASSERT_TRUE(sink.calls == 5);
+
+    DynamicString captured(8);
+    {
+        CaptureSink<32> capture(captured);
+        string_view line[] = { "[", "INFO", "] ", "boot ok", "\n" };
+        capture.writev(line);
+        ASSERT_TRUE(captured.size() == 0);
+    }
+    ASSERT_EQ_STR(captured.c_str(), "[INFO] boot ok\n");
+    return true;
+}
+
+#ifdef HAS_POSIX_FD
+bool Test_FdSink() {
+    int fds[2];
+    ASSERT_TRUE(pipe(fds) == 0);
+    {
+        FdSink<8> sink(fds[1]);
+        sink.write("abc");
+        string_view parts[] = { "defgh", "ijklmnop", "q" };
+        sink.writev(parts);
+        sink.write('r');
+    }
+    close(fds[1]);
+    char buf[32] = {0};
+    ssize_t n = read(fds[0], buf, sizeof(buf) - 1);
+    close(fds[0]);
+    ASSERT_TRUE(n == 18);
+    ASSERT_EQ_STR(buf, "abcdefghijklmnopqr");
+    return true;
+}
+
+static volatile sig_atomic_t g_interrupts = 0;
+static void count_interrupt(int) { g_interrupts = g_interrupts + 1; }
+
+// Fills the pipe, then runs op, which blocks in write(2)/writev(2) until a
+// signal interrupts it and a reader drains the pipe. True if op succeeded
+// and all of its `expect` bytes arrived.
+template <typename F>
+static bool survivesInterrupt(int fds[2], size_t expect, F op) {
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    char fill[4096];
+    memset(fill, 'x', sizeof(fill));
+    size_t queued = 0;
+    for (ssize_t n; (n = write(fds[1], fill, sizeof(fill))) > 0;) queued += static_cast<size_t>(n);
+    fcntl(fds[1], F_SETFL, 0);
+
+    size_t need = queued + expect;
+    pthread_t writer = pthread_self();
+    std::thread reader([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        pthread_kill(writer, SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Non-blocking with a deadline, so a failed op cannot hang the test.
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        char buf[4096];
+        while (need > 0 && std::chrono::steady_clock::now() < deadline) {
+            ssize_t n = read(fds[0], buf, need < sizeof(buf) ? need : sizeof(buf));
+            if (n > 0) need -= static_cast<size_t>(n);
+            else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        fcntl(fds[0], F_SETFL, 0);
+    });
+    bool ok = op();
+    reader.join();
+    return ok && need == 0;
+}
+
+// A signal during a blocked write is retried, not reported as a failure.
+bool Test_FdSink_Interrupted() {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = count_interrupt;  // no SA_RESTART: write() fails with EINTR
+    struct sigaction old;
+    ASSERT_TRUE(sigaction(SIGUSR1, &sa, &old) == 0);
+    int fds[2];
+    ASSERT_TRUE(pipe(fds) == 0);
+    FdSink<8> sink(fds[1]);
+    ASSERT_TRUE(survivesInterrupt(fds, 6, [&] { return sink.write("abcdef") && sink.flush(); }));
+    string_view parts[] = { "0123456789", "abcdefghij" };
+    ASSERT_TRUE(survivesInterrupt(fds, 20, [&] { return sink.writev(parts); }));
+    ASSERT_TRUE(g_interrupts == 2);
+    close(fds[0]);
+    close(fds[1]);
+    sigaction(SIGUSR1, &old, nullptr);
+    return true;
+}
+#endif
+bool Test_Hex_Base64() {
+    const uint8_t payload[] = { 0x00, 0x1F, 0xA0, 0xFF, 0x7E };
+    FixedString<32> hex;
+    ASSERT_TRUE(hex.appendHex(payload, sizeof(payload)));
+    ASSERT_EQ_STR(hex.c_str(), "001fa0ff7e");
+    hex.clear();
+    hex.appendHex(payload, 2, true);
+    ASSERT_EQ_STR(hex.c_str(), "001F");
+
+    uint8_t back[8];
+    ASSERT_TRUE(string_view("001fa0ff7e").decodeHex(back, sizeof(back)) == 5);
+    ASSERT_TRUE(memcmp(back, payload, 5) == 0);
+    ASSERT_TRUE(string_view("0g").decodeHex(back, sizeof(back)) == -1);
+    ASSERT_TRUE(string_view("abc").decodeHex(back, sizeof(back)) == -1);
+
+    DynamicString b64(8);
+    ASSERT_TRUE(b64.appendBase64(string_view("Man")));
+    b64.concat(' ');
+    ASSERT_TRUE(b64.appendBase64(string_view("Ma")));
+    b64.concat(' ');
+    ASSERT_TRUE(b64.appendBase64(string_view("M")));
+    ASSERT_EQ_STR(b64.c_str(), "TWFu TWE= TQ==");
+
+    FixedString<8> decoded;
+    ASSERT_TRUE(string_view("aGVsbG8=").decodeBase64(decoded));
+    ASSERT_EQ_STR(decoded.c_str(), "hello");
+    ASSERT_TRUE(!string_view("aGVs!G8=").decodeBase64(decoded));
+    ASSERT_EQ_STR(decoded.c_str(), "hello");
+    ASSERT_TRUE(string_view("aGk").decodeBase64(back, sizeof(back)) == 2);
+
+    // long inputs go through the SIMD loops; check against the scalar tail
+    uint8_t big[200];
+    for (size_t i = 0; i < sizeof(big); ++i) big[i] = static_cast<uint8_t>(i * 37 + 11);
+    DynamicString enc(8);
+    ASSERT_TRUE(enc.appendBase64(big, sizeof(big)));
+    ASSERT_TRUE(enc.size() == 268);
+    DynamicString dec(8);
+    ASSERT_TRUE(string_view(enc).decodeBase64(dec));
+    ASSERT_TRUE(dec.size() == sizeof(big) && memcmp(dec.c_str(), big, sizeof(big)) == 0);
+    for (size_t i = 0; i < 200; i += 3) {
+        char one[8];
+        base64_encode(big + i, (i + 3 <= 200) ? 3 : 200 - i, one);
+        if (memcmp(enc.c_str() + i / 3 * 4, one, 4) != 0) return false;
+    }
+#if defined(MYSTRING_BASE64_SSSE3)
+    // selected at run time, so a build without -mssse3 still takes it
+    if (__builtin_cpu_supports("ssse3")) {
+        char simd[268];
+        ASSERT_TRUE(base64_encode_ssse3(big, sizeof(big), simd) == 192);
+        ASSERT_TRUE(memcmp(simd, enc.c_str(), 192 / 3 * 4) == 0);
+    }
+#endif
+    DynamicString hexbig(8);
+    hexbig.appendHex(big, sizeof(big), true);
+    for (size_t i = 0; i < sizeof(big); ++i) {
+        ASSERT_TRUE(hexbig[2 * i] == HEX_DIGITS_UPPER[big[i] >> 4]);
+        ASSERT_TRUE(hexbig[2 * i + 1] == HEX_DIGITS_UPPER[big[i] & 0xF]);
+    }
+
+    // truncation keeps whole groups
+    FixedString<6> small;
+    ASSERT_TRUE(!small.appendBase64(string_view("abcdef")));
+    ASSERT_EQ_STR(small.c_str(), "YWJj");
+    return true;
+}
+bool Test_Literal_Overloads() {
+    // literals take their length from the array type, so an embedded
+    // NUL is part of the view; writable buffers are still measured
+    string_view lit("ab\0cd");
+    ASSERT_TRUE(lit.size() == 5);
+    // sized const arrays with spare room end at their first NUL
+    static const char greeting[32] = "hello";
+    ASSERT_TRUE(string_view(greeting).size() == 5 && string_view(greeting) == "hello");
+    struct Named { const char name[16]; };
+    static const Named wifi = {"wifi"};
+    ASSERT_TRUE(string_view(wifi.name).size() == 4);
+    FixedString<32> padded(greeting);
+    ASSERT_TRUE(padded.size() == 5 && padded == "hello");
+    padded = wifi.name;
+    ASSERT_TRUE(padded == "wifi");
+    DynamicString dyn(greeting);
+    ASSERT_TRUE(dyn.size() == 5);
+    char buf[16] = "abc";
+    string_view measured(buf);
+    ASSERT_TRUE(measured.size() == 3);
+    const char* ptr = "pointer";
+    ASSERT_TRUE(string_view(ptr).size() == 7);
+
+    FixedString<16> status = "status";
+    ASSERT_TRUE(status == "status");
+    ASSERT_TRUE(status != "stat");
+    ASSERT_TRUE(status != ptr);
+    ASSERT_TRUE(status.startsWith("sta"));
+    ASSERT_TRUE(status.find("tus") == 3);
+    status = buf;
+    ASSERT_EQ_STR(status.c_str(), "abc");
+    status = ptr;
+    ASSERT_EQ_STR(status.c_str(), "pointer");
+    status = "lit";
+    ASSERT_TRUE(status.size() == 3);
+
+    DynamicString d = "value=";
+    d.concat(42);       // concat(int) is no longer hidden by DynamicString
+    d.concat(" units");
+    ASSERT_EQ_STR(d.c_str(), "value=42 units");
+    ASSERT_TRUE(d.replace("42", "1234"));
+    ASSERT_EQ_STR(d.c_str(), "value=1234 units");
+    ASSERT_TRUE(!d.replace("", "x"));
+
+    string s = "heap";
+    ASSERT_TRUE(s.size() == 4 && s == "heap");
+
+    // the const char* virtuals remain, so code written against them
+    // still compiles and is called for literals and pointers alike
+    struct Counting : public FixedString<32> {
+        int calls = 0;
+        using FixedString<32>::concat;
+        bool concat(const char* str) override {
+            ++calls;
+            return FixedString<32>::concat(str);
+        }
+    };
+    Counting c;
+    c.concat("ab");
+    c.concat(ptr);
+    c.concat(string_view("!"));
+    ASSERT_TRUE(c.calls == 2 && c == "abpointer!");
+    ASSERT_TRUE(!c.concat(static_cast<const char*>(nullptr)));
+    const char* from = "pointer";
+    ASSERT_TRUE(c.replace(from, "ptr") && c == "abptr!");
+
+    // comparing with nullptr means "is empty", as before
+    ASSERT_TRUE(string_view() == nullptr && lit != nullptr);
+    FixedString<8> none;
+    ASSERT_TRUE(none == nullptr && !(status == nullptr));
+    return true;
+}
+bool Test_HeapFree_Numbers() {
+    FixedString<max_chars<int>::value> a = to_fixed(-2147483647 - 1);
+    ASSERT_EQ_STR(a.c_str(), "-2147483648");
+    ASSERT_TRUE(a.capacity() == 11);
+    ASSERT_EQ_STR(to_fixed(0u).c_str(), "0");
+    ASSERT_EQ_STR(to_fixed(18446744073709551615ull).c_str(), "18446744073709551615");
+    ASSERT_EQ_STR(to_fixed(3.14159f).c_str(), "3.14");
+    ASSERT_EQ_STR(to_fixed(-3.4e38f).c_str(), "-3.40e+38");
+    ASSERT_EQ_STR(to_fixed(999999999999999.0).c_str(), "999999999999999.00");
+    ASSERT_EQ_STR(to_fixed(1e15).c_str(), "1.00e+15");
+    ASSERT_EQ_STR(to_fixed(1.7976931348623157e308).c_str(), "1.80e+308");
+    ASSERT_EQ_STR(to_fixed(0.125).c_str(), "0.12");
+    ASSERT_EQ_STR(to_fixed(0.375).c_str(), "0.38");
+    ASSERT_EQ_STR(to_fixed(0.645).c_str(), "0.65");  // 0.64500000000000002
+    ASSERT_EQ_STR(to_fixed(-0.995).c_str(), "-0.99"); // -0.99499999999999999
+    ASSERT_EQ_STR(to_fixed(-0.001).c_str(), "-0.00");
+    ASSERT_EQ_STR(to_fixed(0.0).c_str(), "0.00");
+    double zero = 0.0;
+    ASSERT_EQ_STR(to_fixed(1 / zero).c_str(), "inf");
+    ASSERT_EQ_STR(to_fixed(-1 / zero).c_str(), "-inf");
+    ASSERT_EQ_STR(to_fixed(zero / zero).c_str(), "nan");
+    ASSERT_EQ_STR(to_fixed('x').c_str(), "x");
+    ASSERT_EQ_STR(to_fixed<4>(12345).c_str(), "1234");
+    ASSERT_EQ_STR(to_fixed<8>("label").c_str(), "label");
+
+    FixedString<16> line = "T=";
+    ASSERT_TRUE(to_chars(line, 23.5f));
+    ASSERT_TRUE(to_chars(line, ','));
+    ASSERT_TRUE(to_chars(line, -7L));
+    ASSERT_EQ_STR(line.c_str(), "T=23.50,-7");
+    ASSERT_TRUE(!to_chars(line, 1234567));
+
+    char raw[4];
+    ASSERT_TRUE(to_chars(raw, raw + 4, 9999) == raw + 4);
+    ASSERT_TRUE(to_chars(raw, raw + 4, -999) == raw + 4);
+    ASSERT_TRUE(to_chars(raw, raw + 4, 10000) == nullptr);
+
+    DynamicString d(8);
+    d.concat(-42);
+    d.concat(1.5f);
+    ASSERT_EQ_STR(d.c_str(), "-421.50");
+    return true;
+}
+bool Test_FlatStringMap() {
+    string_view keys[] = { "wifi.ssid", "mqtt.host", "wifi.pass", "mqtt.port",
+                           "led", "wifi.ssid", "mqtt.hostname", "a" };
+    int values[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    FlatStringMap<int, 8, 64, 4> map;
+    ASSERT_TRUE(map.build(keys, values, 8));
+    ASSERT_TRUE(map.size() == 7);
+    ASSERT_TRUE(*map.get("wifi.ssid") == 6);  // duplicate: last one wins
+    ASSERT_TRUE(*map.get("mqtt.host") == 2);
+    ASSERT_TRUE(*map.get("mqtt.hostname") == 7);
+    ASSERT_TRUE(*map.get("a") == 8);
+    ASSERT_TRUE(!map.contains("mqtt"));
+    ASSERT_TRUE(!map.contains("mqtt.hostnamex"));
+    ASSERT_TRUE(!map.contains(""));
+    ASSERT_TRUE(!map.contains("zzz"));
+
+    FixedString<32> key;
+    ASSERT_TRUE(map.keyAt(3, key));
+    ASSERT_EQ_STR(key.c_str(), "mqtt.hostname");
+    // front coding stores less than the raw key bytes plus one byte each
+    ASSERT_TRUE(map.arenaUsed() < 7 + 9 + 9 + 9 + 9 + 3 + 13 + 1);
+
+    FlatStringMap<int, 2, 8> tiny;
+    ASSERT_TRUE(!tiny.build(keys, values, 3));
+    ASSERT_TRUE(!tiny.build(keys, values, 2));
+    ASSERT_TRUE(tiny.size() == 0 && !tiny.contains("led"));
+
+    // shared prefixes longer than the 255-byte prefix field
+    static char longkeys[6][300];
+    string_view lk[6];
+    int lv[6];
+    for (int i = 0; i < 6; ++i) {
+        memset(longkeys[i], 'k', 280);
+        longkeys[i][280] = static_cast<char>('f' - i);
+        longkeys[i][281] = '\0';
+        lk[i] = string_view(longkeys[i], 281 - (i == 5 ? 1 : 0));
+        lv[i] = i;
+    }
+    FlatStringMap<int, 6, 2048, 8> longmap;
+    ASSERT_TRUE(longmap.build(lk, lv, 6));
+    for (int i = 0; i < 6; ++i) ASSERT_TRUE(longmap.get(lk[i]) && *longmap.get(lk[i]) == i);
+    ASSERT_TRUE(!longmap.contains(string_view(longkeys[0], 279)));
+    return true;
+}
+#if __cplusplus >= 201402L
+static constexpr Route ROUTES[] = {
+    { "/api/", 1 }, { "/api/v2/", 2 }, { "/api/v2/status", 3 }, { "/app", 4 }, { "/", 0 }
+};
+static constexpr auto routeIndex = makePrefixIndex<12, 24>(ROUTES);
+static_assert(!routeIndex.overflowed(), "route table does not fit");
+#endif
+
+bool Test_PrefixIndex() {
+    PrefixIndex<16, 64> idx;
+    ASSERT_TRUE(idx.add("GET /led", 10));
+    ASSERT_TRUE(idx.add("GET /", 11));
+    ASSERT_TRUE(idx.add("GET /ledstrip", 12));
+    ASSERT_TRUE(idx.add("POST /cfg", 13));
+    ASSERT_TRUE(idx.add("GET /le", 14));
+
+    size_t len = 0;
+    ASSERT_TRUE(idx.match("GET /ledstrip/on", &len) == 12 && len == 13);
+    ASSERT_TRUE(idx.match("GET /leds", &len) == 10 && len == 8);
+    ASSERT_TRUE(idx.match("GET /lx") == 11);
+    ASSERT_TRUE(idx.match("GET /le") == 14);
+    ASSERT_TRUE(idx.match("POST /cfg?x=1") == 13);
+    ASSERT_TRUE(idx.match("POST /") == -1);
+    ASSERT_TRUE(idx.match("") == -1);
+    ASSERT_TRUE(idx.add("GET /led", 20));
+    ASSERT_TRUE(idx.match("GET /led") == 20);
+    ASSERT_TRUE(idx.add("", 99));
+    ASSERT_TRUE(idx.match("PUT /x", &len) == 99 && len == 0);
+
+    PrefixIndex<2, 64> full;
+    ASSERT_TRUE(full.add("abc", 1));
+    ASSERT_TRUE(!full.add("abd", 2));
+    ASSERT_TRUE(full.overflowed());
+
+#if __cplusplus >= 201402L
+    ASSERT_TRUE(routeIndex.match("/api/v2/status?verbose") == 3);
+    ASSERT_TRUE(routeIndex.match("/api/v2/config") == 2);
+    ASSERT_TRUE(routeIndex.match("/api/v1/") == 1);
+    ASSERT_TRUE(routeIndex.match("/apple") == 4);
+    ASSERT_TRUE(routeIndex.match("/index.html") == 0);
+    ASSERT_TRUE(routeIndex.match("index.html") == -1);
+#endif
+    return true;
+}
+bool Test_MappedFile_Lines() {
+    const char text[] = "first\r\nsecond\n\nlast";
+    char path[] = "/tmp/mystring_test_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_TRUE(write(fd, text, sizeof(text) - 1) == (ssize_t)(sizeof(text) - 1));
+    close(fd);
+
+    const char* expected[] = { "first", "second", "", "last" };
+    {
+        MappedFile file(path);
+        ASSERT_TRUE(file.isOpen() && file.isMapped());
+        ASSERT_TRUE(file.view() == text);
+        size_t n = 0;
+        for (const string_view& line : file.lines()) {
+            ASSERT_TRUE(n < 4 && line == expected[n]);
+            ++n;
+        }
+        ASSERT_TRUE(n == 4);
+    }
+    unlink(path);
+
+    // pipes cannot be mapped and go through the buffered fallback
+    int fds[2];
+    ASSERT_TRUE(pipe(fds) == 0);
+    std::thread writer([&]() {
+        for (int i = 0; i < 20000; ++i) {
+            if (write(fds[1], "0123456789\n", 11) != 11) break;
+        }
+        close(fds[1]);
+    });
+    MappedFile piped;
+    bool opened = piped.openFd(fds[0]);
+    writer.join();
+    ASSERT_TRUE(opened && !piped.isMapped());
+    ASSERT_TRUE(piped.size() == 220000);
+    size_t count = 0;
+    for (const string_view& line : piped.lines()) {
+        if (line != "0123456789") return false;
+        ++count;
+    }
+    ASSERT_TRUE(count == 20000);
+    ASSERT_TRUE(!MappedFile("/nonexistent/file").isOpen());
+
+    // /proc files report size 0 but have contents
+    MappedFile proc("/proc/self/status");
+    ASSERT_TRUE(proc.isOpen() && !proc.isMapped() && proc.view().startsWith("Name:"));
+
+    // a failed openFd closes fd itself and does not keep it
+    int dir = ::open("/tmp", O_RDONLY);
+    ASSERT_TRUE(dir >= 0);
+    MappedFile failed;
+    ASSERT_TRUE(!failed.openFd(dir) && !failed.isOpen());
+    ASSERT_TRUE(fcntl(dir, F_GETFD) == -1);
+    return true;
+}
+#if __cplusplus >= 201402L
+static constexpr TopicFilter<4> tempFilter("sensors/+/temp");
+static_assert(tempFilter.valid(), "filter must compile");
+static_assert(!TopicFilter<4>("a/#/b").valid(), "'#' must be last");
+static constexpr GlobPattern<4> logGlob("*.log");
+#endif
+
+bool Test_TopicFilter() {
+    TopicFilter<8> all("#");
+    ASSERT_TRUE(all.matches("a/b/c") && all.matches("a") && !all.matches("$SYS/info"));
+    TopicFilter<8> sport("sport/tennis/#");
+    ASSERT_TRUE(sport.matches("sport/tennis"));
+    ASSERT_TRUE(sport.matches("sport/tennis/player1/ranking"));
+    ASSERT_TRUE(!sport.matches("sport/tennisx"));
+    ASSERT_TRUE(!sport.matches("sport"));
+    TopicFilter<8> plus("+/+");
+    ASSERT_TRUE(plus.matches("/finance") && plus.matches("a/b"));
+    ASSERT_TRUE(!plus.matches("a") && !plus.matches("a/b/c"));
+    TopicFilter<8> exact("home/kitchen");
+    ASSERT_TRUE(exact.matches("home/kitchen") && !exact.matches("home/kitchen/"));
+    TopicFilter<8> sys("$SYS/+");
+    ASSERT_TRUE(sys.matches("$SYS/uptime"));
+    ASSERT_TRUE(!TopicFilter<8>("a/b+").valid());
+    ASSERT_TRUE(!TopicFilter<2>("a/b/c").valid());
+    // filters read into a config buffer end at the NUL, not the array
+    char configured[32] = "sensors/+/temp";
+    TopicFilter<8> fromConfig(configured);
+    ASSERT_TRUE(fromConfig.valid() && fromConfig.matches("sensors/a/temp"));
+#if __cplusplus >= 201402L
+    ASSERT_TRUE(tempFilter.matches("sensors/kitchen/temp"));
+    ASSERT_TRUE(!tempFilter.matches("sensors/kitchen/hum"));
+#endif
+    return true;
+}
+
+bool Test_GlobPattern() {
+    ASSERT_TRUE(GlobPattern<4>("*.log").matches("boot.log"));
+    ASSERT_TRUE(!GlobPattern<4>("*.log").matches("boot.log.1"));
+    ASSERT_TRUE(GlobPattern<4>("data_??.csv").matches("data_07.csv"));
+    ASSERT_TRUE(!GlobPattern<4>("data_??.csv").matches("data_7.csv"));
+    ASSERT_TRUE(GlobPattern<4>("a*b*c").matches("abc"));
+    ASSERT_TRUE(GlobPattern<4>("a*b*c").matches("axxbyybzc"));
+    ASSERT_TRUE(!GlobPattern<4>("a*b*c").matches("axxbyybz"));
+    ASSERT_TRUE(!GlobPattern<4>("ab*ba").matches("aba"));
+    ASSERT_TRUE(GlobPattern<4>("*").matches("") && GlobPattern<4>("**").matches("x"));
+    ASSERT_TRUE(GlobPattern<4>("").matches("") && !GlobPattern<4>("").matches("x"));
+    ASSERT_TRUE(!GlobPattern<2>("a*b*c*d").valid());
+    char configured[32] = "*.log";
+    ASSERT_TRUE(GlobPattern<4>(configured).matches("boot.log"));
+
+    // the classic exponential case for backtracking matchers
+    char text[101];
+    memset(text, 'a', 100);
+    text[100] = '\0';
+    ASSERT_TRUE(!GlobPattern<16>("a*a*a*a*a*a*a*a*a*b").matches(text));
+    // the quadratic case of the segment search: still correct, just slower
+    ASSERT_TRUE(!GlobPattern<4>("*aaab*").matches(text));
+#if __cplusplus >= 201402L
+    ASSERT_TRUE(logGlob.matches("x.log"));
+#endif
+    return true;
+}
+bool Test_JsonTokenizer() {
+    const char* payload =
+        "{\"id\":\"node-7\",\"sensor\":{\"temp\":21.5,\"hum\":40,\"tags\":[\"a\",\"b\"]},"
+        "\"readings\":[{\"v\":1},{\"v\":-2}],\"ok\":true,\"name\":\"caf\\u00e9 \\\"x\\\"\"}";
+    JsonTokenizer json(payload);
+
+    JsonToken tok;
+    ASSERT_TRUE(json.get("sensor.temp", tok));
+    double temp = 0;
+    ASSERT_TRUE(tok.type == JSON_NUMBER && tok.toDouble(temp) && temp == 21.5);
+    long hum = 0;
+    ASSERT_TRUE(json.get("sensor.hum", tok) && tok.toInt(hum) && hum == 40);
+    ASSERT_TRUE(json.get("readings.1.v", tok) && tok.toInt(hum) && hum == -2);
+
+    // toInt range-checks against long; toDouble refuses over-long tokens
+    char limits[160];
+    snprintf(limits, sizeof(limits), "[%ld,%ld,%lu0,99999999999999999999,-0,1.%s]", LONG_MAX, LONG_MIN,
+             (unsigned long)LONG_MAX, "0000000000000000000000000000000001");
+    JsonTokenizer edge(limits);
+    ASSERT_TRUE(edge.get("0", tok) && tok.toInt(hum) && hum == LONG_MAX);
+    ASSERT_TRUE(edge.get("1", tok) && tok.toInt(hum) && hum == LONG_MIN);
+    ASSERT_TRUE(edge.get("2", tok) && !tok.toInt(hum));
+    ASSERT_TRUE(edge.get("3", tok) && !tok.toInt(hum));
+    ASSERT_TRUE(edge.get("4", tok) && tok.toInt(hum) && hum == 0);
+    ASSERT_TRUE(edge.get("5", tok) && !tok.toDouble(temp));
+    ASSERT_TRUE(json.get("sensor.tags", tok) && tok.text == "[\"a\",\"b\"]");
+    ASSERT_TRUE(json.get("ok", tok) && tok.type == JSON_TRUE);
+    ASSERT_TRUE(json.get("id", tok) && tok.text == "node-7" && !tok.escaped);
+    ASSERT_TRUE(!json.get("sensor.pressure", tok));
+    ASSERT_TRUE(!json.get("readings.5", tok));
+    ASSERT_TRUE(!json.get("id.x", tok));
+
+    // the value "hum" must not be found as a key
+    ASSERT_TRUE(!JsonTokenizer("{\"k\":\"hum\",\"x\":{\"hum\":1}}").get("hum", tok));
+
+    ASSERT_TRUE(json.get("name", tok) && tok.escaped);
+    FixedString<32> name;
+    ASSERT_TRUE(tok.unescape(name) && name == "caf\xc3\xa9 \"x\"");
+    FixedString<4> tiny;
+    ASSERT_TRUE(!tok.unescape(tiny));
+
+    JsonTokenizer flat("[1, \"two\", null]");
+    JsonTokenType expected[] = { JSON_ARRAY_START, JSON_NUMBER, JSON_STRING, JSON_NULL, JSON_ARRAY_END };
+    for (JsonTokenType type : expected) {
+        ASSERT_TRUE(flat.next(tok) && tok.type == type);
+    }
+    ASSERT_TRUE(!flat.next(tok) && tok.type == JSON_END);
+
+    JsonTokenizer broken("{\"a\":[1}");
+    while (broken.next(tok)) {}
+    ASSERT_TRUE(tok.type == JSON_ERROR);
+    return true;
+}
+bool Test_BufferString() {
+    char rx[16] = "GET /led HTTP";
+    BufferString frame(rx, sizeof(rx), 13);
+    ASSERT_TRUE(frame == "GET /led HTTP" && frame.capacity() == 15);
+    ASSERT_TRUE(frame.replace("/led", "/fan"));
+    ASSERT_TRUE(memcmp(rx, "GET /fan HTTP", 14) == 0);  // edited in place
+    ASSERT_TRUE(frame.data() == rx);
+    frame.concat("/1.1");
+    ASSERT_TRUE(frame == "GET /fan HTTP/1");  // truncated at the buffer size
+    ASSERT_TRUE(rx[15] == '\0');
+    frame.clear();
+    frame = "ok";
+    ASSERT_TRUE(strcmp(rx, "ok") == 0);
+
+    // An unterminated frame uses every byte and never writes past it.
+    char dma[6] = { 'a', 'b', 'c', 'd', '#', '!' };
+    BufferString raw(dma, 5, 4, BUFFER_UNTERMINATED);
+    ASSERT_TRUE(!raw.isTerminated() && raw.capacity() == 5);
+    raw.concat("xyz");
+    ASSERT_TRUE(raw == "abcdx" && dma[5] == '!');
+    raw.truncate(2);
+    ASSERT_TRUE(raw == "ab" && dma[2] == 'c');
+
+    BufferString copy(rx, sizeof(rx));
+    ASSERT_TRUE(copy.size() == 0);
+    return true;
+}
+bool Test_Substr_Insert_Erase() {
+    string_view line("key=value;rest");
+    ASSERT_TRUE(line.substr(4, 5) == "value" && line.substr(4, 5).data() == line.data() + 4);
+    ASSERT_TRUE(line.substr(10) == "rest" && line.substr(99).size() == 0);
+    ASSERT_TRUE(line.slice(0, 3) == "key" && line.slice(4, 99) == "value;rest");
+    ASSERT_TRUE(line.slice(5, 2).size() == 0);
+    ASSERT_TRUE(line.removePrefix(4) == "value;rest" && line.removeSuffix(5) == "key=value");
+    ASSERT_TRUE(line.removeSuffix(50).size() == 0 && line == "key=value;rest");
+
+    FixedString<12> fixed("held");
+    ASSERT_TRUE(fixed.insert(0, "on ") && fixed == "on held");
+    ASSERT_TRUE(fixed.insert(fixed.size(), "!") && fixed == "on held!");
+    ASSERT_TRUE(!fixed.insert(2, "xxxxx") && fixed == "on held!");  // would not fit
+    ASSERT_TRUE(!fixed.insert(20, "x"));
+    ASSERT_TRUE(fixed.erase(2, 5) && fixed == "on!");
+    ASSERT_TRUE(fixed.erase(1) && fixed == "o" && !fixed.erase(5));
+
+    DynamicString dyn("abcdef");
+    for (int i = 0; i < 20; ++i) ASSERT_TRUE(dyn.insert(3, "--"));
+    ASSERT_TRUE(dyn.size() == 46 && dyn.startsWith("abc--") && dyn.find("def") == 43);
+    ASSERT_TRUE(dyn.erase(3, 40) && dyn == "abcdef");
+
+    // Inserting a view of the string itself, across a reallocation.
+    DynamicString self("0123456789");
+    ASSERT_TRUE(self.insert(4, self.substr(2, 4)) && self == "01232345456789");
+    DynamicString self2("abcd");
+    ASSERT_TRUE(self2.insert(1, self2.substr(2)) && self2 == "acdbcd");
+    ASSERT_TRUE(self2.insert(4, self2.substr(0, 2)) && self2 == "acdbaccd");
+    return true;
+}
+bool Test_Compact_Layout() {
+    static_assert(FixedString<8>::capacity() == 8, "capacity is a compile-time constant");
+    static_assert(sizeof(CompactString<300>) <= 304, "two length bytes above 255");
+
+    CompactString<8> names[4];
+    ASSERT_TRUE(sizeof(names) == 4 * 10);
+    ASSERT_TRUE(sizeof(FixedString<8>) >= 3 * sizeof(CompactString<8>));
+
+    names[0] = "temp";
+    ASSERT_TRUE(names[0] == "temp" && names[0].size() == 4 && strcmp(names[0].c_str(), "temp") == 0);
+    ASSERT_TRUE(names[0].concat('_') && names[0].concat("in"));
+    ASSERT_TRUE(!names[0].concat("door") && names[0] == "temp_ind");
+    ASSERT_TRUE(!names[1].assign("humidity!") && names[1] == "humidity");
+    names[2] = names[1];
+    ASSERT_TRUE(names[2].view().startsWith("humid"));
+    names[2].clear();
+    ASSERT_TRUE(names[2].size() == 0 && names[2] != names[1]);
+
+    // The slimmer string header must not change owned or adopted strings.
+    string owned("heap copy");
+    string moved(static_cast<string&&>(owned));
+    ASSERT_TRUE(moved == "heap copy" && owned.size() == 0);
+    ASSERT_TRUE(moved.c_str() == moved.data() && moved.data() == string_view(moved).data());
+    return true;
+}
+bool Test_Batch_Ops() {
+    // Enough lines for several chunks, with a ragged last word.
+    const size_t count = 3 * BATCH_GRAIN + 77;
+    const char* levels[] = { "INFO boot", "WARN temp high", "ERROR sensor 7", "INFO link up" };
+    std::vector<std::string> storage(count);
+    std::vector<string_view> lines(count);
+    for (size_t i = 0; i < count; ++i) {
+        storage[i] = std::string(levels[(i * 7) % 4]) + " #" + std::to_string(count - i);
+        lines[i] = string_view(storage[i].data(), storage[i].size());
+    }
+
+    BatchPool pool(4);
+    ASSERT_TRUE(pool.threads() == 4);
+
+    size_t errors = 0, warnings = 0;
+    for (size_t i = 0; i < count; ++i) {
+        errors += lines[i].startsWith("ERROR") ? 1 : 0;
+        warnings += lines[i].startsWith("WARN") ? 1 : 0;
+    }
+    ASSERT_TRUE(batchCount(pool, lines.data(), count, TextStartsWith("ERROR")) == errors);
+    ASSERT_TRUE(batchCount(pool, lines.data(), count,
+                           [](const string_view& s) { return s.find("ERROR") == 0; }) == errors);
+
+    BatchBitmap hits;
+    batchFilter(pool, lines.data(), count, TextContains("temp"), hits);
+    ASSERT_TRUE(hits.size() == count && hits.count() == warnings);
+    std::vector<uint32_t> indices;
+    hits.toIndices(indices);
+    for (size_t k = 0; k < indices.size(); ++k) ASSERT_TRUE(lines[indices[k]].startsWith("WARN"));
+
+    std::vector<int> pos(count);
+    batchFind(pool, lines.data(), count, "#", pos.data());
+    for (size_t i = 0; i < count; ++i) ASSERT_TRUE(pos[i] == lines[i].find("#"));
+
+    batchSort(pool, lines.data(), count);
+    for (size_t i = 1; i < count; ++i) ASSERT_TRUE(lines[i - 1].compare(lines[i]) <= 0);
+
+    BatchPool single(1);
+    ASSERT_TRUE(batchCount(single, lines.data(), count, TextStartsWith("ERROR")) == errors);
+    return true;
+}
+bool Test_Fuzzy_Matching() {
+    ASSERT_TRUE(string_view("kitten").editDistance("sitting", 5) == 3);
+    ASSERT_TRUE(string_view("kitten").editDistance("sitting", 2) == -1);
+    ASSERT_TRUE(string_view("reboot").editDistance("reboot", 0) == 0);
+    ASSERT_TRUE(string_view("").editDistance("abc", 3) == 3);
+    ASSERT_TRUE(string_view("ab").editDistance("abcdefgh", 3) == -1);  // length gap alone
+
+    // Patterns longer than one machine word use several blocks.
+    FuzzyPattern<200> longPattern("the quick brown fox jumps over the lazy dog, then the quick brown fox naps");
+    ASSERT_TRUE(longPattern.distance("the quick brown fox jumped over the lazy dog, then the quick brown cat naps", 10) == 5);
+
+    size_t len = 0;
+    string_view log("boot ok; sensr fault at 12:00");
+    ASSERT_TRUE(log.fuzzyFind("sensor", 1, &len) == 9 && len == 5);
+    ASSERT_TRUE(log.fuzzyFind("boot", 0, &len) == 0 && len == 4);
+    ASSERT_TRUE(log.fuzzyFind("relay", 1) == -1);
+
+    const char* const commands[] = { "status", "reboot", "restart", "reset", "set", "stats", "help" };
+    FuzzyMatch best[3];
+    ASSERT_TRUE(fuzzySuggest("rest", commands, 7, 2, best, 3) == 2);
+    size_t found = fuzzySuggest("rest", commands, 7, 3, best, 3);
+    ASSERT_TRUE(found == 3);
+    ASSERT_TRUE(best[0].index == 3 && best[0].distance == 1);  // reset
+    ASSERT_TRUE(best[1].index == 4 && best[1].distance == 2);  // set
+    ASSERT_TRUE(best[2].index == 1 && best[2].distance == 3);  // reboot, first of the 3s
+    ASSERT_TRUE(fuzzySuggest("stauts", commands, 7, 2, best, 1) == 1 && best[0].index == 5);
+    ASSERT_TRUE(fuzzySuggest("xyzzy", commands, 7, 1, best, 3) == 0);
+    return true;
+}
+#if __cplusplus >= 201402L
+static constexpr const char* UI_FRAGMENTS[] = { "Battery ", "low", ", please ", "connect", " charger" };
+static constexpr auto uiBook = makeCodebook(UI_FRAGMENTS);
+static_assert(!uiBook.overflowed() && uiBook.size() == 5, "codebook index is built at compile time");
+#endif
+
+bool Test_Small_Compression() {
+    const char* samples[] = {
+        "Battery low, please connect charger",
+        "ERROR: sensor timeout after 500 ms",
+        "WiFi connected",
+        "",
+        "zzzz qqqq xxxx \xfe\xff binary",
+    };
+    for (const char* text : samples) {
+        DynamicString packed(8), unpacked(8);
+        ASSERT_TRUE(smallCompress(defaultCodebook(), text, packed));
+        ASSERT_TRUE(smallDecompress(defaultCodebook(), packed, unpacked));
+        ASSERT_TRUE(unpacked == string_view(text));
+    }
+
+    DynamicString packed(8);
+    smallCompress(defaultCodebook(), "Battery low, please connect charger", packed);
+    ASSERT_TRUE(packed.size() * 2 < 35);
+
+    // Literal runs longer than 256 bytes are split.
+    char noise[600];
+    for (size_t i = 0; i < sizeof(noise); ++i) noise[i] = static_cast<char>(0x80 + i % 100);
+    DynamicString big(8), back(8);
+    ASSERT_TRUE(smallCompress(defaultCodebook(), string_view(noise, sizeof(noise)), big));
+    ASSERT_TRUE(smallDecompress(defaultCodebook(), big, back) && back == string_view(noise, sizeof(noise)));
+
+    // Decompression fails cleanly on bad input or a short destination.
+    FixedString<8> small("x");
+    ASSERT_TRUE(!smallDecompress(defaultCodebook(), packed, small) && small == "x");
+    const char truncated[] = { '\xff', '\x05', 'a' };
+    ASSERT_TRUE(!smallDecompress(defaultCodebook(), string_view(truncated, 3), back));
+    ASSERT_TRUE(!smallCompress(defaultCodebook(), "a long sentence that cannot fit", small));
+
+#if __cplusplus >= 201402L
+    FixedString<16> ui;
+    ASSERT_TRUE(smallCompress(uiBook, "Battery low, please connect charger", ui) && ui.size() == 5);
+    FixedString<40> text;
+    ASSERT_TRUE(smallDecompress(uiBook, ui, text) && text == "Battery low, please connect charger");
+#endif
+    return true;
+}
+bool Test_Escaping() {
+    DynamicString url(8);
+    ASSERT_TRUE(url.appendUrlEncoded("a b&c=d/\xc3\xa9~x_y.z-0"));
+    ASSERT_TRUE(url == "a%20b%26c%3Dd%2F%C3%A9~x_y.z-0");
+    DynamicString plain(8);
+    ASSERT_TRUE(plain.appendUrlDecoded(url) && plain == "a b&c=d/\xc3\xa9~x_y.z-0");
+    ASSERT_TRUE(!plain.appendUrlDecoded("bad%2") && !plain.appendUrlDecoded("%zz"));
+
+    DynamicString json(8);
+    ASSERT_TRUE(json.appendJsonEscaped("say \"hi\"\n\tback\\slash \x01 caf\xc3\xa9"));
+    ASSERT_TRUE(json == "say \\\"hi\\\"\\n\\tback\\\\slash \\u0001 caf\xc3\xa9");
+    DynamicString back(8);
+    ASSERT_TRUE(back.appendJsonUnescaped(json) && back == "say \"hi\"\n\tback\\slash \x01 caf\xc3\xa9");
+    back.clear();
+    ASSERT_TRUE(back.appendJsonUnescaped("\\u00e9\\ud83d\\ude00\\/") && back == "\xc3\xa9\xf0\x9f\x98\x80/");
+    ASSERT_TRUE(!back.appendJsonUnescaped("\\ud83d") && !back.appendJsonUnescaped("\\q"));
+
+    DynamicString c(8);
+    ASSERT_TRUE(c.appendCEscaped("it's \"x\"\r\n\x7f\xff" "1"));
+    ASSERT_TRUE(c == "it\\'s \\\"x\\\"\\r\\n\\177\\3771");
+    DynamicString cback(8);
+    ASSERT_TRUE(cback.appendCUnescaped(c) && cback == "it's \"x\"\r\n\x7f\xff" "1");
+    cback.clear();
+    ASSERT_TRUE(cback.appendCUnescaped("\\x41\\101\\0\\a") && cback == string_view("AA\0\a", 4));
+
+    // Long clean runs go through the word/SIMD scan; escapes straddle it.
+    char long_text[100];
+    for (size_t i = 0; i < sizeof(long_text); ++i) long_text[i] = (i % 37 == 36) ? '"' : 'a' + i % 26;
+    DynamicString esc(8), unesc(8);
+    ASSERT_TRUE(esc.appendJsonEscaped(string_view(long_text, sizeof(long_text))));
+    ASSERT_TRUE(esc.size() == sizeof(long_text) + 2);
+    ASSERT_TRUE(unesc.appendJsonUnescaped(esc) && unesc == string_view(long_text, sizeof(long_text)));
+
+    // Truncation keeps whole escapes.
+    FixedString<8> small;
+    ASSERT_TRUE(!small.appendUrlEncoded("abcd f g") && small == "abcd%20f");
+    FixedString<4> tiny("ab");
+    ASSERT_TRUE(!tiny.appendJsonUnescaped("cde") && tiny == "ab");
+    return true;
+}
+bool Test_Checksums() {
+    const char* check = "123456789";
+    Crc32 crc32;
+    crc32.update(check);
+    ASSERT_TRUE(crc32.value() == 0xCBF43926u);
+    Crc32c crc32c;
+    crc32c.update(check);
+    ASSERT_TRUE(crc32c.value() == 0xE3069283u);
+    Crc16Modbus modbus;
+    modbus.update(check);
+    ASSERT_TRUE(modbus.value() == 0x4B37);
+    Crc16CcittFalse ccitt;
+    ccitt.update(check);
+    ASSERT_TRUE(ccitt.value() == 0x29B1);
+    Crc16Xmodem xmodem;
+    xmodem.update(check);
+    ASSERT_TRUE(xmodem.value() == 0x31C3);
+    Crc16Kermit kermit;
+    kermit.update(check);
+    ASSERT_TRUE(kermit.value() == 0x2189);
+    Xor8 x;
+    x.update(check);
+    ASSERT_TRUE(x.value() == 0x31);
+    Lrc8 lrc;
+    lrc.update(check);
+    ASSERT_TRUE(lrc.value() == 0x23);
+
+    // Chunked updates match one pass, across the 8-byte slicing boundary.
+    char data[100];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = static_cast<char>(i * 37 + 11);
+    Crc32 whole;
+    whole.update(string_view(data, sizeof(data)));
+    Crc32c whole_c, soft_c;
+    whole_c.update(string_view(data, sizeof(data)));
+    soft_c.updateSoftware(string_view(data, sizeof(data)));
+    ASSERT_TRUE(whole_c.value() == soft_c.value());
+    for (size_t cut = 0; cut <= sizeof(data); cut += 13) {
+        Crc32 parts;
+        parts.update(string_view(data, cut));
+        parts.update(string_view(data + cut, sizeof(data) - cut));
+        ASSERT_TRUE(parts.value() == whole.value());
+        Crc32c parts_c;
+        parts_c.update(string_view(data, cut));
+        parts_c.updateSoftware(string_view(data + cut, sizeof(data) - cut));
+        ASSERT_TRUE(parts_c.value() == whole_c.value());
+    }
+    crc32.reset();
+    crc32.update(string_view(data, sizeof(data)));
+    ASSERT_TRUE(crc32.value() == whole.value());
+
+    // Hex trailers.
+    FixedString<16> frame("123456789");
+    ASSERT_TRUE(appendChecksumHex(frame, modbus) && frame == "1234567894B37");
+    ASSERT_TRUE(verifyTrailingHex<Crc16Modbus>(frame));
+    ASSERT_TRUE(verifyTrailingHex<Crc16Modbus>("1234567894b37"));
+    ASSERT_TRUE(!verifyTrailingHex<Crc16Modbus>("1234567894B38"));
+    ASSERT_TRUE(!verifyTrailingHex<Crc32>("4B37"));
+    FixedString<12> tight("123456789");
+    ASSERT_TRUE(!appendChecksumHex(tight, crc32c));
+
+    // NMEA sentences.
+    ASSERT_TRUE(nmeaChecksumValid("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"));
+    ASSERT_TRUE(!nmeaChecksumValid("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*48"));
+    ASSERT_TRUE(!nmeaChecksumValid("GPGGA*47") && !nmeaChecksumValid("$*4"));
+    FixedString<32> sentence("$PMTK220,1000");
+    ASSERT_TRUE(appendNmeaChecksum(sentence) && sentence == "$PMTK220,1000*1F");
+    ASSERT_TRUE(nmeaChecksumValid(sentence));
+    return true;
+}
+#if __cplusplus >= 202002L
+bool Test_Scan() {
+    float t = 0;
+    int h = 0;
+    unsigned id = 0;
+    ScanResult r = scan<"T=%f,H=%d,ID=%u">("T=23.5,H=-40,ID=7;next", t, h, id);
+    ASSERT_TRUE(r.complete && r.count == 3 && r.position == 17);
+    ASSERT_TRUE(t == 23.5f && h == -40 && id == 7);
+
+    // No terminator needed: the view ends mid-buffer.
+    const char buf[] = "ID=12345";
+    r = scan<"ID=%u">(string_view(buf, 5), id);
+    ASSERT_TRUE(r.complete && id == 12);
+
+    // Stops at the first mismatch and reports how far it got.
+    r = scan<"T=%f,H=%d,ID=%u">("T=1e2,H=x", t, h, id);
+    ASSERT_TRUE(!r.complete && r.count == 1 && r.position == 8 && t == 100.0f);
+    r = scan<"T=%f">("X=1", t);
+    ASSERT_TRUE(!r.complete && r.count == 0 && r.position == 0);
+
+    // Range checks per argument type.
+    uint8_t small = 0;
+    int8_t tiny = 0;
+    ASSERT_TRUE(scan<"%u">("255", small).complete && small == 255);
+    ASSERT_TRUE(!scan<"%u">("256", small).complete && small == 255);
+    ASSERT_TRUE(scan<"%d">("-128", tiny).complete && tiny == -128);
+    ASSERT_TRUE(!scan<"%d">("128", tiny).complete);
+    long long big = 0;
+    ASSERT_TRUE(scan<"%d">("-9223372036854775808", big).complete && big == (-9223372036854775807LL - 1));
+    ASSERT_TRUE(!scan<"%d">("99999999999999999999", big).complete);
+
+    // Text, hex, chars and %%.
+    string_view name;
+    FixedString<8> copy;
+    unsigned long mask = 0;
+    char unit = 0;
+    r = scan<"%s:%s|%x %c 100%%">("dev:kitchen|1aF C 100%", name, copy, mask, unit);
+    ASSERT_TRUE(r.complete && name == "dev" && copy == "kitchen" && mask == 0x1af && unit == 'C');
+    ASSERT_TRUE(!scan<"%s">("far too long for it", copy).complete);
+    // A non-ASCII byte after %s still ends it: "21.5°C,5".
+    int n = 0;
+    r = scan<"%s\xC2\xB0" "C,%d">("21.5\xC2\xB0" "C,5", name, n);
+    ASSERT_TRUE(r.complete && r.count == 2 && name == "21.5" && n == 5);
+
+    double d = 0;
+    ASSERT_TRUE(scan<"%f">("-0.000125", d).complete && d == -0.000125);
+    ASSERT_TRUE(scan<"%f">("6.02214076e23", d).complete && d > 6.0221407e23 && d < 6.0221408e23);
+    ASSERT_TRUE(scan<"%fe">("3e", d).complete && d == 3.0);
+    ASSERT_TRUE(!scan<"%f">(".", d).complete);
+    return true;
+}
+#endif
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+PipeStage collectFrames(DynamicString& log) {
+    string_view msg;
+    while (co_await receive(msg)) {
+        log.concat(msg);
+        log.concat('|');
+    }
+    log.concat("end");
+}
+
+bool Test_Pipeline() {
+    // Every split of the stream gives the same lines.
+    const char* stream = "alpha\r\nbeta\n\nthis line is too long\ngamma\r\ntail";
+    size_t len = strlen(stream);
+    for (size_t step = 1; step <= len; ++step) {
+        DynamicString log(16);
+        FrameStats stats;
+        {
+            PipeStage sink = collectFrames(log);
+            PipeStage framer = lineFramer<8>(sink, &stats);
+            for (size_t i = 0; i < len; i += step) {
+                ASSERT_TRUE(framer.push(string_view(stream + i, (len - i < step) ? len - i : step)));
+            }
+            framer.close();
+            ASSERT_TRUE(framer.done() && sink.done() && !framer.push("x"));
+        }
+        ASSERT_TRUE(log == "alpha|beta||gamma|end");
+        ASSERT_TRUE(stats.frames == 4 && stats.dropped == 1);
+        if (step == len) ASSERT_TRUE(stats.copied == 0);
+    }
+
+    // Length-prefixed: 2-byte big-endian sizes, one oversized message.
+    const char framed[] = "\x00\x03" "abc" "\x00\x00" "\x00\x0a" "too long!!" "\x00\x02" "ok";
+    size_t flen = sizeof(framed) - 1;
+    for (size_t step = 1; step <= flen; ++step) {
+        DynamicString log(16);
+        FrameStats stats;
+        PipeStage sink = collectFrames(log);
+        PipeStage framer = lengthFramer<4>(sink, &stats);
+        for (size_t i = 0; i < flen; i += step) {
+            framer.push(string_view(framed + i, (flen - i < step) ? flen - i : step));
+        }
+        framer.close();
+        ASSERT_TRUE(log == "abc||ok|end");
+        ASSERT_TRUE(stats.frames == 3 && stats.dropped == 1);
+    }
+    return true;
+}
+#endif
 int main() {
     std::cout << "Running String Library Unit Tests...\n";
     std::cout << "------------------------------------\n";
@@ -176,6 +1328,40 @@ int main() {
     RUN_TEST(Test_MoveSemantics);
     RUN_TEST(Test_Replace);
     RUN_TEST(Test_Polymorphism);
+    RUN_TEST(Test_Utf8_Validation);
+    RUN_TEST(Test_Utf8_Truncation);
+    RUN_TEST(Test_MultiMatcher);
+    RUN_TEST(Test_StreamMatcher);
+    RUN_TEST(Test_SpscQueue_Basics);
+    RUN_TEST(Test_SpscQueue_Threads);
+    RUN_TEST(Test_Sink_Batching);
+#ifdef HAS_POSIX_FD
+    RUN_TEST(Test_FdSink);
+    RUN_TEST(Test_FdSink_Interrupted);
+#endif
+    RUN_TEST(Test_Hex_Base64);
+    RUN_TEST(Test_Literal_Overloads);
+    RUN_TEST(Test_HeapFree_Numbers);
+    RUN_TEST(Test_FlatStringMap);
+    RUN_TEST(Test_PrefixIndex);
+    RUN_TEST(Test_MappedFile_Lines);
+    RUN_TEST(Test_TopicFilter);
+    RUN_TEST(Test_GlobPattern);
+    RUN_TEST(Test_JsonTokenizer);
+    RUN_TEST(Test_BufferString);
+    RUN_TEST(Test_Substr_Insert_Erase);
+    RUN_TEST(Test_Compact_Layout);
+    RUN_TEST(Test_Batch_Ops);
+    RUN_TEST(Test_Fuzzy_Matching);
+    RUN_TEST(Test_Small_Compression);
+    RUN_TEST(Test_Escaping);
+    RUN_TEST(Test_Checksums);
+#if __cplusplus >= 202002L
+    RUN_TEST(Test_Scan);
+#endif
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+    RUN_TEST(Test_Pipeline);
+#endif
 
     std::cout << "------------------------------------\n";
     std::cout << "Tests Completed.\n";
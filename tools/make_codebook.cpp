@@ -0,0 +1,89 @@
+// Builds a compression codebook for mystring_compress.hpp from a corpus
+// with one string per line (UI texts, log templates). Fragments of 2..12
+// bytes are ranked by the bytes they would save, (length - 1) * count; the
+// best is taken, its occurrences are masked out of the corpus so that
+// overlapping fragments lose their counts, and the ranking is repeated.
+// Single bytes common enough to be worth a code fill the remaining slots.
+//
+//   g++ -std=c++17 -O2 make_codebook.cpp -o make_codebook
+//   ./make_codebook corpus.txt [entries] > codebook.inc     (default 254)
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char MASK = '\x01';  // never part of a chosen fragment
+
+static void print_entry(const std::string& s) {
+    putchar('"');
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c == '\n') printf("\\n");
+        else if (c < 0x20 || c >= 0x7F) printf("\\x%02X\"\"", c);
+        else putchar(c);
+    }
+    printf("\", ");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s corpus.txt [entries]\n", argv[0]);
+        return 1;
+    }
+    size_t wanted = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 254;
+    if (wanted == 0 || wanted > 254) wanted = 254;
+
+    std::ifstream in(argv[1]);
+    std::vector<std::string> corpus;
+    for (std::string line; std::getline(in, line);) corpus.push_back(line);
+
+    std::vector<std::string> book;
+    while (book.size() < wanted) {
+        std::map<std::string, size_t> counts;
+        for (const std::string& line : corpus) {
+            for (size_t i = 0; i < line.size(); ++i) {
+                for (size_t len = 2; len <= 12 && i + len <= line.size(); ++len) {
+                    std::string frag = line.substr(i, len);
+                    if (frag.find(MASK) != std::string::npos) break;
+                    ++counts[frag];
+                }
+            }
+        }
+        std::string best;
+        size_t best_gain = 0;
+        for (const auto& kv : counts) {
+            size_t gain = (kv.first.size() - 1) * kv.second;
+            if (gain > best_gain) { best_gain = gain; best = kv.first; }
+        }
+        if (best_gain < 4) break;  // not worth a code
+        book.push_back(best);
+        for (std::string& line : corpus) {
+            for (size_t pos = line.find(best); pos != std::string::npos; pos = line.find(best, pos + 1)) {
+                line.replace(pos, best.size(), 1, MASK);
+            }
+        }
+    }
+
+    // Leftover bytes: a code is still one byte, but it avoids a literal escape.
+    std::map<unsigned char, size_t> singles;
+    for (const std::string& line : corpus) {
+        for (unsigned char c : line) if (c != (unsigned char)MASK) ++singles[c];
+    }
+    std::vector<std::pair<size_t, unsigned char>> ranked;
+    for (const auto& kv : singles) ranked.push_back({ kv.second, kv.first });
+    std::sort(ranked.rbegin(), ranked.rend());
+    for (size_t i = 0; i < ranked.size() && book.size() < wanted; ++i) {
+        book.push_back(std::string(1, static_cast<char>(ranked[i].second)));
+    }
+
+    printf("static constexpr const char* CODEBOOK[] = {\n    ");
+    for (size_t i = 0; i < book.size(); ++i) {
+        print_entry(book[i]);
+        if (i % 8 == 7) printf("\n    ");
+    }
+    printf("\n};\n");
+    return 0;
+}